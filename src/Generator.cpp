@@ -49,12 +49,125 @@ bool compareXsName(const Xsd::Name& name, const String& rh)
     return name.xsdNamespace == "http://www.w3.org/2001/XMLSchema" && name.name == rh;
 }
 
+String toCCharLiteral(char c)
+{
+    if (c >= ' ' && c <= '~' && c != '\'' && c != '\\')
+        return String::fromPrintf("'%c'", c);
+    return String::fromPrintf("(char)0x%02x", (uint)(unsigned char)c);
+}
+
+struct NameSwitchCase
+{
+    String name;
+    String result;
+};
+
+struct ElementEvent
+{
+    String name;
+    Xsd::Name typeName;
+};
+
+struct ChildEvent
+{
+    String childInfo; // or empty for a child of a type in an external namespace
+    String name;
+    Xsd::Name typeName;
+};
+
+struct RecordPath
+{
+    String name; // <parent type>_<element>
+    String childInfo;
+    Xsd::Name typeName;
+};
+
+// Generates a switch over the length of `name` and one of its characters that resolves a name
+// from `cases` with a single memcmp. The code returns the result of the matching case and falls
+// through otherwise.
+void generateNameSwitch(const List<NameSwitchCase>& cases, const String& indent, List<String>& output)
+{
+    usize maxLength = 0;
+    for (List<NameSwitchCase>::Iterator i = cases.begin(), end = cases.end(); i != end; ++i)
+        if (i->name.length() > maxLength)
+            maxLength = i->name.length();
+
+    output.append(indent + "switch (length)");
+    output.append(indent + "{");
+    for (usize length = 0; length <= maxLength; ++length)
+    {
+        List<const NameSwitchCase*> lengthCases;
+        for (List<NameSwitchCase>::Iterator i = cases.begin(), end = cases.end(); i != end; ++i)
+            if (i->name.length() == length)
+                lengthCases.append(&*i);
+        if (lengthCases.isEmpty())
+            continue;
+
+        output.append(indent + "case " + String::fromUInt64(length) + ":");
+        if (lengthCases.size() == 1)
+        {
+            const NameSwitchCase& switchCase = *lengthCases.front();
+            output.append(indent + "    if (memcmp(name, " + toCStringLiteral(switchCase.name) + ", " + String::fromUInt64(length) + ") == 0)");
+            output.append(indent + "        return " + switchCase.result + ";");
+            output.append(indent + "    break;");
+            continue;
+        }
+
+        // pick the character position that distinguishes most names
+        usize bestIndex = 0;
+        usize bestCount = 0;
+        for (usize index = 0; index < length; ++index)
+        {
+            bool seen[256] = {};
+            usize count = 0;
+            for (List<const NameSwitchCase*>::Iterator i = lengthCases.begin(), end = lengthCases.end(); i != end; ++i)
+            {
+                unsigned char c = ((const char*)(*i)->name)[index];
+                if (!seen[c])
+                {
+                    seen[c] = true;
+                    ++count;
+                }
+            }
+            if (count > bestCount)
+            {
+                bestCount = count;
+                bestIndex = index;
+            }
+        }
+
+        output.append(indent + "    switch (name[" + String::fromUInt64(bestIndex) + "])");
+        output.append(indent + "    {");
+        bool seen[256] = {};
+        for (List<const NameSwitchCase*>::Iterator i = lengthCases.begin(), end = lengthCases.end(); i != end; ++i)
+        {
+            char c = ((const char*)(*i)->name)[bestIndex];
+            if (seen[(unsigned char)c])
+                continue;
+            seen[(unsigned char)c] = true;
+            output.append(indent + "    case " + toCCharLiteral(c) + ":");
+            for (List<const NameSwitchCase*>::Iterator j = i; j != end; ++j)
+                if (((const char*)(*j)->name)[bestIndex] == c)
+                {
+                    output.append(indent + "        if (memcmp(name, " + toCStringLiteral((*j)->name) + ", " + String::fromUInt64(length) + ") == 0)");
+                    output.append(indent + "            return " + (*j)->result + ";");
+                }
+            output.append(indent + "        break;");
+        }
+        output.append(indent + "    }");
+        output.append(indent + "    break;");
+    }
+    output.append(indent + "}");
+}
+
 class Generator
 {
 public:
-    Generator(const Xsd& xsd, const List<String>& externalNamespacePrefixes, const List<String>& forceTypeProcessing, List<String>& cppOutput, List<String>& hppOutput)
+    Generator(const Xsd& xsd, const List<String>& externalNamespacePrefixes, const List<String>& forceTypeProcessing, uint32 flags, usize maxDepth, List<String>& cppOutput, List<String>& hppOutput)
         : _xsd(xsd)
         , _externalNamespacePrefixes(externalNamespacePrefixes)
+        , _flags(flags)
+        , _maxDepth(maxDepth)
         , _cppOutputFinal(cppOutput)
         , _hppOutput(hppOutput)
     {
@@ -92,10 +205,22 @@ public:
         HashMap<String, HashSet<Xsd::Name>> externalTypes;
         if (!collectReferencedExternalTypes(localElementTypes, externalTypes))
             return false;
+        {
+            // the event handlers identify elements of external types by their ElementInfo
+            const Xsd::Type& rootType = *_xsd.types.find(_xsd.rootType);
+            for (List<Xsd::ElementRef>::Iterator i = rootType.elements.begin(), end = rootType.elements.end(); i != end; ++i)
+            {
+                List<ElementEvent> events;
+                collectElementEvents(*i, events);
+                for (List<ElementEvent>::Iterator i = events.begin(), end = events.end(); i != end; ++i)
+                {
+                    String namespacePrefix;
+                    if (isNamespaceExternal(i->typeName.xsdNamespace, namespacePrefix))
+                        externalTypes.append(namespacePrefix, HashSet<Xsd::Name>(), false).append(i->typeName);
+                }
+            }
+        }
 
-        _cppOutputFinal.append("");
-        _cppOutputFinal.append(String("#include \"") + _cppNamespace + ".hpp\"");
-        _cppOutputFinal.append("");
 
         for (HashMap<String, HashSet<Xsd::Name>>::Iterator i = externalTypes.begin(), end = externalTypes.end(); i != end; ++i)
         {
@@ -106,7 +231,7 @@ public:
             {
                 String cppName = toCppTypeIdentifier2(*i);
                 _cppOutputFinal.append(String("extern const xsdcpp::ElementInfo _") + cppName + "_Info;");
-                _cppOutputFinal.append(String("void _set_") + cppName + "(" + toCppTypeIdentifierWithNamespace2(*i) + "*, const xsdcpp::Position&, std::string&&);");
+                _cppOutputFinal.append(String("xsd::error::code_t _set_") + cppName + "(" + toCppTypeIdentifierWithNamespace2(*i) + "*, const char*, size_t);");
             }
             _cppOutputFinal.append("");
             _cppOutputFinal.append("}");
@@ -123,6 +248,7 @@ public:
             _cppOutputAnonymousFieldGetter.append("    \"http://www.w3.org/2001/XMLSchema\",");
         _cppOutputAnonymousFieldGetter.append("    nullptr");
         _cppOutputAnonymousFieldGetter.append("};");
+        _cppOutputAnonymousFieldGetter.append(String("const size_t _maxDepth = ") + String::fromUInt64(_maxDepth) + ";");
         _cppOutputAnonymousFieldGetter.append("");
 
         _hppOutput.append("");
@@ -175,8 +301,113 @@ public:
             String elementTypeCppName = toCppTypeIdentifier2(i->typeName);
             String elementCppName = toCppFieldIdentifier(i->name);
 
+            if (_flags & ViewStringsFlag)
+            {
+                // a view model can only be loaded from a mutable buffer that outlives it
+                _hppOutput.append(String("void load_view(char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ");");
+                _hppOutput.append(String("bool try_load_view(char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+                _hppOutput.append(String("inline void load_view(std::string& data, ") + elementTypeCppName + "& " + elementCppName + ") { load_view(&data[0], data.size(), " + elementCppName + "); }");
+                _hppOutput.append(String("inline bool try_load_view(std::string& data, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error) { return try_load_view(&data[0], data.size(), " + elementCppName + ", error); }");
+                _hppOutput.append("");
+                continue;
+            }
+
             _hppOutput.append(String("void load_file(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ");");
             _hppOutput.append(String("void load_data(const std::string& data, ") + elementTypeCppName + "& " + elementCppName + ");");
+            _hppOutput.append(String("void load_data(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ");");
+            _hppOutput.append(String("void load_data_in_place(char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ");");
+            _hppOutput.append(String("void load_file_parallel(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ", size_t threads = 0);");
+            _hppOutput.append(String("void load_data_parallel(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", size_t threads = 0);");
+            _hppOutput.append(String("std::vector<xsd::error> load_files(const std::vector<std::string>& files, std::vector<") + elementTypeCppName + ">& " + elementCppName + "s, size_t threads = 0);");
+            _hppOutput.append("#ifdef XSDCPP_HAS_STRING_VIEW");
+            _hppOutput.append(String("inline void load_data(std::string_view data, ") + elementTypeCppName + "& " + elementCppName + ") { load_data(data.data(), data.size(), " + elementCppName + "); }");
+            _hppOutput.append(String("inline void load_data(const char* data, ") + elementTypeCppName + "& " + elementCppName + ") { load_data(std::string_view(data), " + elementCppName + "); }");
+            _hppOutput.append("#endif");
+            _hppOutput.append("");
+            _hppOutput.append(String("bool try_load_file(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+            _hppOutput.append(String("bool try_load_data(const std::string& data, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+            _hppOutput.append(String("bool try_load_data(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+            _hppOutput.append(String("bool try_load_data_in_place(char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+            _hppOutput.append(String("bool try_load_file_parallel(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ", size_t threads, xsd::error& error);");
+            _hppOutput.append(String("bool try_load_data_parallel(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", size_t threads, xsd::error& error);");
+            _hppOutput.append("#ifdef XSDCPP_HAS_STRING_VIEW");
+            _hppOutput.append(String("inline bool try_load_data(std::string_view data, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error) { return try_load_data(data.data(), data.size(), " + elementCppName + ", error); }");
+            _hppOutput.append(String("inline bool try_load_data(const char* data, ") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error) { return try_load_data(std::string_view(data), " + elementCppName + ", error); }");
+            _hppOutput.append("#endif");
+            _hppOutput.append("");
+
+            String parserCppName = elementCppName + "Parser";
+            _hppOutput.append(String("class ") + parserCppName);
+            _hppOutput.append("{");
+            _hppOutput.append("public:");
+            _hppOutput.append(String("    ") + parserCppName + "();");
+            _hppOutput.append(String("    ~") + parserCppName + "();");
+            _hppOutput.append("");
+            _hppOutput.append("    void write(const char* data, size_t length);");
+            _hppOutput.append(String("    void finish(") + elementTypeCppName + "& " + elementCppName + ");");
+            _hppOutput.append("");
+            _hppOutput.append("    bool try_write(const char* data, size_t length, xsd::error& error);");
+            _hppOutput.append(String("    bool try_finish(") + elementTypeCppName + "& " + elementCppName + ", xsd::error& error);");
+            _hppOutput.append("");
+            _hppOutput.append("private:");
+            _hppOutput.append("    struct Private;");
+            _hppOutput.append("    Private* _private;");
+            _hppOutput.append("");
+            _hppOutput.append(String("    ") + parserCppName + "(const " + parserCppName + "&);");
+            _hppOutput.append(String("    ") + parserCppName + "& operator=(const " + parserCppName + "&);");
+            _hppOutput.append("};");
+            _hppOutput.append("");
+
+            List<ElementEvent> events;
+            collectElementEvents(*i, events);
+            String handlerCppName = elementCppName + "Handler";
+            _hppOutput.append(String("class ") + handlerCppName);
+            _hppOutput.append("{");
+            _hppOutput.append("public:");
+            _hppOutput.append(String("    virtual ~") + handlerCppName + "() {}");
+            _hppOutput.append("");
+            for (List<ElementEvent>::Iterator i = events.begin(), end = events.end(); i != end; ++i)
+            {
+                String eventCppName = toCppIdentifier(i->name);
+                String eventTypeCppName = toCppTypeIdentifierWithNamespace2(i->typeName);
+                _hppOutput.append(String("    virtual void on_start_") + eventCppName + "(const " + eventTypeCppName + "&) {}");
+                _hppOutput.append(String("    virtual void on_end_") + eventCppName + "(const " + eventTypeCppName + "&) {}");
+            }
+            _hppOutput.append("};");
+            _hppOutput.append("");
+            List<RecordPath> recordPaths;
+            {
+                HashSet<Xsd::Name> visitedTypes;
+                collectRecordPaths(i->typeName, visitedTypes, recordPaths);
+            }
+            if (!recordPaths.isEmpty())
+            {
+                String callbacksCppName = elementCppName + "Callbacks";
+                _hppOutput.append(String("struct ") + callbacksCppName);
+                _hppOutput.append("{");
+                for (List<RecordPath>::Iterator i = recordPaths.begin(), end = recordPaths.end(); i != end; ++i)
+                    _hppOutput.append(String("    std::function<void(") + toCppTypeIdentifierWithNamespace2(i->typeName) + "&)> " + i->name + ";");
+                _hppOutput.append("};");
+                _hppOutput.append("");
+                _hppOutput.append(String("void load_file(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks);");
+                _hppOutput.append(String("void load_data(const std::string& data, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks);");
+                _hppOutput.append(String("void load_data(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks);");
+                _hppOutput.append(String("bool try_load_file(const std::string& file, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks, xsd::error& error);");
+                _hppOutput.append(String("bool try_load_data(const std::string& data, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks, xsd::error& error);");
+                _hppOutput.append(String("bool try_load_data(const char* data, size_t length, ") + elementTypeCppName + "& " + elementCppName + ", const " + callbacksCppName + "& callbacks, xsd::error& error);");
+                _hppOutput.append("");
+            }
+
+            _hppOutput.append(String("void parse_file(const std::string& file, ") + handlerCppName + "& handler);");
+            _hppOutput.append(String("void parse_data(const std::string& data, ") + handlerCppName + "& handler);");
+            _hppOutput.append(String("void parse_data(const char* data, size_t length, ") + handlerCppName + "& handler);");
+            _hppOutput.append("#ifdef XSDCPP_HAS_STRING_VIEW");
+            _hppOutput.append(String("inline void parse_data(std::string_view data, ") + handlerCppName + "& handler) { parse_data(data.data(), data.size(), handler); }");
+            _hppOutput.append(String("inline void parse_data(const char* data, ") + handlerCppName + "& handler) { parse_data(std::string_view(data), handler); }");
+            _hppOutput.append("#endif");
+            _hppOutput.append(String("bool try_parse_file(const std::string& file, ") + handlerCppName + "& handler, xsd::error& error);");
+            _hppOutput.append(String("bool try_parse_data(const std::string& data, ") + handlerCppName + "& handler, xsd::error& error);");
+            _hppOutput.append(String("bool try_parse_data(const char* data, size_t length, ") + handlerCppName + "& handler, xsd::error& error);");
             _hppOutput.append("");
         }
 
@@ -216,25 +447,390 @@ public:
         _cppOutputFinal.append("");
 
         String rootTypeCppName = toCppTypeIdentifier2(_xsd.rootType);
+        _cppOutputFinal.append(String("void* _new_") + rootTypeCppName + "() { return new " + rootTypeCppName + "; }");
+        _cppOutputFinal.append(String("void _delete_") + rootTypeCppName + "(void* element) { delete (" + rootTypeCppName + "*)element; }");
+        _cppOutputFinal.append("");
         for (List<Xsd::ElementRef>::Iterator i = rootType.elements.begin(), end = rootType.elements.end(); i != end; ++i)
         {
             String elementTypeCppName = toCppTypeIdentifier2(i->typeName);
             String elementCppName = toCppFieldIdentifier(i->name);
 
+            if (_flags & ViewStringsFlag)
+            {
+                _cppOutputFinal.append(String("bool try_load_view(char* data, size_t length, ") + elementTypeCppName + "& output, xsd::error& error)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+                _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
+                _cppOutputFinal.append("    if (!xsdcpp::parseInPlace(data, length, _namespaces, elementContext, nullptr, _maxDepth, error))");
+                _cppOutputFinal.append("        return false;");
+                _cppOutputFinal.append(String("    output = std::move(rootElement.") + elementCppName + ");");
+                _cppOutputFinal.append("    return true;");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("void load_view(char* data, size_t length, ") + elementTypeCppName + "& output)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    xsd::error error;");
+                _cppOutputFinal.append("    if (!try_load_view(data, length, output, error))");
+                _cppOutputFinal.append("        xsdcpp::throwError(error);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+                continue;
+            }
+
+            _cppOutputFinal.append(String("bool try_load_data(const char* data, size_t length, ") + elementTypeCppName + "& output, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            appendInternTableScope();
+            _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+            _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
+            _cppOutputFinal.append("    if (!xsdcpp::parse(data, length, _namespaces, elementContext, nullptr, _maxDepth, error))");
+            _cppOutputFinal.append("        return false;");
+            _cppOutputFinal.append(String("    output = std::move(rootElement.") + elementCppName + ");");
+            _cppOutputFinal.append("    return true;");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_load_data_in_place(char* data, size_t length, ") + elementTypeCppName + "& output, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            appendInternTableScope();
+            _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+            _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
+            _cppOutputFinal.append("    if (!xsdcpp::parseInPlace(data, length, _namespaces, elementContext, nullptr, _maxDepth, error))");
+            _cppOutputFinal.append("        return false;");
+            _cppOutputFinal.append(String("    output = std::move(rootElement.") + elementCppName + ");");
+            _cppOutputFinal.append("    return true;");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_load_data(const std::string& data, ") + elementTypeCppName + "& output, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    return try_load_data(data.data(), data.size(), output, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_load_file(const std::string& filePath, ") + elementTypeCppName + "& output, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsdcpp::FileContent file;");
+            _cppOutputFinal.append("    return file.open(filePath, error) && try_load_data(file.data(), file.size(), output, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void load_data(const char* data, size_t length, ") + elementTypeCppName + "& output)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_load_data(data, length, output, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
             _cppOutputFinal.append(String("void load_data(const std::string& data, ") + elementTypeCppName + "& output)");
             _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    load_data(data.data(), data.size(), output);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void load_data_in_place(char* data, size_t length, ") + elementTypeCppName + "& output)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_load_data_in_place(data, length, output, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_load_data_parallel(const char* data, size_t length, ") + elementTypeCppName + "& output, size_t threads, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            appendInternTableScope();
             _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
             _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
-            _cppOutputFinal.append("    xsdcpp::parse(data.c_str(), _namespaces, elementContext);");
+            _cppOutputFinal.append("#ifdef XSDCPP_ARENA");
+            _cppOutputFinal.append("    xsd::arena* arena = xsd::arena::current(); // the parts are allocated from the arena of the calling thread");
+            _cppOutputFinal.append(String("    if (!xsdcpp::parseParallel(data, length, _namespaces, elementContext, _maxDepth, [arena]() -> void* { xsd::arena::current() = arena; return _new_") + rootTypeCppName + "(); }, &_delete_" + rootTypeCppName + ", threads, error))");
+            _cppOutputFinal.append("#else");
+            _cppOutputFinal.append(String("    if (!xsdcpp::parseParallel(data, length, _namespaces, elementContext, _maxDepth, &_new_") + rootTypeCppName + ", &_delete_" + rootTypeCppName + ", threads, error))");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("        return false;");
             _cppOutputFinal.append(String("    output = std::move(rootElement.") + elementCppName + ");");
+            _cppOutputFinal.append("    return true;");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_load_file_parallel(const std::string& filePath, ") + elementTypeCppName + "& output, size_t threads, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsdcpp::FileContent file;");
+            _cppOutputFinal.append("    return file.open(filePath, error) && try_load_data_parallel(file.data(), file.size(), output, threads, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void load_data_parallel(const char* data, size_t length, ") + elementTypeCppName + "& output, size_t threads)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_load_data_parallel(data, length, output, threads, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void load_file_parallel(const std::string& filePath, ") + elementTypeCppName + "& output, size_t threads)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_load_file_parallel(filePath, output, threads, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
             _cppOutputFinal.append("}");
             _cppOutputFinal.append("");
 
             _cppOutputFinal.append(String("void load_file(const std::string& filePath, ") + elementTypeCppName + "& output)");
             _cppOutputFinal.append("{");
-            _cppOutputFinal.append("    load_data(xsdcpp::read_file(filePath), output);");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_load_file(filePath, output, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("std::vector<xsd::error> load_files(const std::vector<std::string>& filePaths, std::vector<") + elementTypeCppName + ">& outputs, size_t threads)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    std::vector<xsd::error> errors(filePaths.size());");
+            _cppOutputFinal.append("    outputs.clear();");
+            _cppOutputFinal.append("    outputs.resize(filePaths.size());");
+            _cppOutputFinal.append("#ifdef XSDCPP_ARENA");
+            _cppOutputFinal.append("    xsd::arena* arena = xsd::arena::current(); // the documents are allocated from the arena of the calling thread");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("#ifdef XSDCPP_EXCEPTIONS");
+            _cppOutputFinal.append("    std::vector<std::exception_ptr> exceptions(filePaths.size()); // e.g. std::bad_alloc, rethrown after all threads are joined");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("    xsdcpp::forEachParallel(filePaths.size(), threads, [&](size_t i) {");
+            _cppOutputFinal.append("#ifdef XSDCPP_ARENA");
+            _cppOutputFinal.append("        xsd::arena::current() = arena;");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("#ifdef XSDCPP_EXCEPTIONS");
+            _cppOutputFinal.append("        try");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("        {");
+            _cppOutputFinal.append("            try_load_file(filePaths[i], outputs[i], errors[i]);");
+            _cppOutputFinal.append("        }");
+            _cppOutputFinal.append("#ifdef XSDCPP_EXCEPTIONS");
+            _cppOutputFinal.append("        catch (...)");
+            _cppOutputFinal.append("        {");
+            _cppOutputFinal.append("            exceptions[i] = std::current_exception();");
+            _cppOutputFinal.append("        }");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("    });");
+            _cppOutputFinal.append("#ifdef XSDCPP_EXCEPTIONS");
+            _cppOutputFinal.append("    for (std::vector<std::exception_ptr>::const_iterator i = exceptions.begin(), end = exceptions.end(); i != end; ++i)");
+            _cppOutputFinal.append("        if (*i)");
+            _cppOutputFinal.append("            std::rethrow_exception(*i);");
+            _cppOutputFinal.append("#endif");
+            _cppOutputFinal.append("    return errors;");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            String parserCppName = elementCppName + "Parser";
+            _cppOutputFinal.append(String("struct ") + parserCppName + "::Private");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+            _cppOutputFinal.append("    xsdcpp::PushParser parser;");
+            if (_flags & InternStringAttributesFlag)
+                _cppOutputFinal.append("    xsd::intern_table internTable;");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append(String("    Private() : parser(_namespaces, &_") + rootTypeCppName + "_Info, &rootElement, _maxDepth) {}");
+            _cppOutputFinal.append("};");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append(parserCppName + "::" + parserCppName + "() : _private(new Private) {}");
+            _cppOutputFinal.append(parserCppName + "::~" + parserCppName + "() { delete _private; }");
+            if (_flags & InternStringAttributesFlag)
+                _cppOutputFinal.append(String("bool ") + parserCppName + "::try_write(const char* data, size_t length, xsd::error& error) { xsd::intern_table::scope internScope(_private->internTable); return _private->parser.write(data, length, error); }");
+            else
+                _cppOutputFinal.append(String("bool ") + parserCppName + "::try_write(const char* data, size_t length, xsd::error& error) { return _private->parser.write(data, length, error); }");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append(String("bool ") + parserCppName + "::try_finish(" + elementTypeCppName + "& output, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            if (_flags & InternStringAttributesFlag)
+                _cppOutputFinal.append("    xsd::intern_table::scope internScope(_private->internTable);");
+            _cppOutputFinal.append("    if (!_private->parser.finish(error))");
+            _cppOutputFinal.append("        return false;");
+            _cppOutputFinal.append(String("    output = std::move(_private->rootElement.") + elementCppName + ");");
+            _cppOutputFinal.append("    return true;");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append(String("void ") + parserCppName + "::write(const char* data, size_t length)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_write(data, length, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
             _cppOutputFinal.append("}");
             _cppOutputFinal.append("");
+            _cppOutputFinal.append(String("void ") + parserCppName + "::finish(" + elementTypeCppName + "& output)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_finish(output, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            String handlerCppName = elementCppName + "Handler";
+            String eventsCppName = String("_") + handlerCppName + "_Events";
+            List<ChildEvent> childEvents;
+            collectChildEvents(rootType, *i, childEvents);
+            _cppOutputFinal.append(String("struct ") + eventsCppName + " : xsdcpp::ElementHandler");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append(String("    ") + handlerCppName + "& handler;");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append(String("    ") + eventsCppName + "(" + handlerCppName + "& handler) : handler(handler) {}");
+            _cppOutputFinal.append("");
+            _cppOutputFinal.append("    void startElement(const xsdcpp::ChildElementInfo& child, void* element) override { onStart(child, element); }");
+            _cppOutputFinal.append("    bool endElement(const xsdcpp::ChildElementInfo& child, void* element) override { onEnd(child, element); return true; }");
+            for (int endEvent = 0; endEvent < 2; ++endEvent)
+            {
+                _cppOutputFinal.append("");
+                _cppOutputFinal.append(String("    void ") + (endEvent ? "onEnd" : "onStart") + "(const xsdcpp::ChildElementInfo& child, const void* element)");
+                _cppOutputFinal.append("    {");
+                // the child element infos of an external namespace are numbered by its own generated code, so the
+                // address of a child element info has to be checked as well
+                _cppOutputFinal.append("        switch (child.handlerEvent)");
+                _cppOutputFinal.append("        {");
+                for (List<ChildEvent>::Iterator i = childEvents.begin(), end = childEvents.end(); i != end; ++i)
+                    if (!i->childInfo.isEmpty())
+                    {
+                        _cppOutputFinal.append(String("        case ") + String::fromUInt64(*_childElementInfoIndices.find(i->childInfo)) + ":");
+                        _cppOutputFinal.append(String("            if (&child == &") + i->childInfo + ")");
+                        _cppOutputFinal.append(String("                return handler.") + (endEvent ? "on_end_" : "on_start_") + toCppIdentifier(i->name) + "(*(const " + toCppTypeIdentifierWithNamespace2(i->typeName) + "*)element);");
+                        _cppOutputFinal.append("            break;");
+                    }
+                _cppOutputFinal.append("        }");
+                for (List<ChildEvent>::Iterator i = childEvents.begin(), end = childEvents.end(); i != end; ++i)
+                    if (i->childInfo.isEmpty())
+                    {
+                        _cppOutputFinal.append(String("        if (child.info == &") + toCppNamespacePrefix(i->typeName) + "::_" + toCppTypeIdentifier2(i->typeName) + "_Info && strcmp(child.name, \"" + i->name + "\") == 0)");
+                        _cppOutputFinal.append(String("            handler.") + (endEvent ? "on_end_" : "on_start_") + toCppIdentifier(i->name) + "(*(const " + toCppTypeIdentifierWithNamespace2(i->typeName) + "*)element);");
+                    }
+                _cppOutputFinal.append("    }");
+            }
+            _cppOutputFinal.append("};");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_parse_data(const char* data, size_t length, ") + handlerCppName + "& handler, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            appendInternTableScope();
+            _cppOutputFinal.append(String("    ") + eventsCppName + " events(handler);");
+            _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+            _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
+            _cppOutputFinal.append("    return xsdcpp::parse(data, length, _namespaces, elementContext, &events, _maxDepth, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_parse_data(const std::string& data, ") + handlerCppName + "& handler, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    return try_parse_data(data.data(), data.size(), handler, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("bool try_parse_file(const std::string& filePath, ") + handlerCppName + "& handler, xsd::error& error)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsdcpp::FileContent file;");
+            _cppOutputFinal.append("    return file.open(filePath, error) && try_parse_data(file.data(), file.size(), handler, error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void parse_data(const char* data, size_t length, ") + handlerCppName + "& handler)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_parse_data(data, length, handler, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void parse_data(const std::string& data, ") + handlerCppName + "& handler)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    parse_data(data.data(), data.size(), handler);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            _cppOutputFinal.append(String("void parse_file(const std::string& filePath, ") + handlerCppName + "& handler)");
+            _cppOutputFinal.append("{");
+            _cppOutputFinal.append("    xsd::error error;");
+            _cppOutputFinal.append("    if (!try_parse_file(filePath, handler, error))");
+            _cppOutputFinal.append("        xsdcpp::throwError(error);");
+            _cppOutputFinal.append("}");
+            _cppOutputFinal.append("");
+
+            List<RecordPath> recordPaths;
+            {
+                HashSet<Xsd::Name> visitedTypes;
+                collectRecordPaths(i->typeName, visitedTypes, recordPaths);
+            }
+            if (!recordPaths.isEmpty())
+            {
+                String callbacksCppName = elementCppName + "Callbacks";
+                String recordsCppName = String("_") + callbacksCppName + "_Records";
+                _cppOutputFinal.append(String("struct ") + recordsCppName + " : xsdcpp::ElementHandler");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append(String("    const ") + callbacksCppName + "& callbacks;");
+                _cppOutputFinal.append("");
+                _cppOutputFinal.append(String("    ") + recordsCppName + "(const " + callbacksCppName + "& callbacks) : callbacks(callbacks) {}");
+                _cppOutputFinal.append("");
+                _cppOutputFinal.append("    void startElement(const xsdcpp::ChildElementInfo&, void*) override {}");
+                _cppOutputFinal.append("");
+                _cppOutputFinal.append("    bool endElement(const xsdcpp::ChildElementInfo& child, void* element) override");
+                _cppOutputFinal.append("    {");
+                for (List<RecordPath>::Iterator i = recordPaths.begin(), end = recordPaths.end(); i != end; ++i)
+                {
+                    _cppOutputFinal.append(String("        if (&child == &") + i->childInfo + " && callbacks." + i->name + ")");
+                    _cppOutputFinal.append("        {");
+                    _cppOutputFinal.append(String("            callbacks.") + i->name + "(*(" + toCppTypeIdentifierWithNamespace2(i->typeName) + "*)element);");
+                    _cppOutputFinal.append("            return true;");
+                    _cppOutputFinal.append("        }");
+                }
+                _cppOutputFinal.append("        return false;");
+                _cppOutputFinal.append("    }");
+                _cppOutputFinal.append("};");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("bool try_load_data(const char* data, size_t length, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks, xsd::error& error)");
+                _cppOutputFinal.append("{");
+                appendInternTableScope();
+                _cppOutputFinal.append(String("    ") + recordsCppName + " records(callbacks);");
+                _cppOutputFinal.append(String("    ") + rootTypeCppName + " rootElement;");
+                _cppOutputFinal.append(String("    xsdcpp::ElementContext elementContext(&_") + rootTypeCppName + "_Info, &rootElement);");
+                _cppOutputFinal.append("    if (!xsdcpp::parse(data, length, _namespaces, elementContext, &records, _maxDepth, error))");
+                _cppOutputFinal.append("        return false;");
+                _cppOutputFinal.append(String("    output = std::move(rootElement.") + elementCppName + ");");
+                _cppOutputFinal.append("    return true;");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("bool try_load_data(const std::string& data, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks, xsd::error& error)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    return try_load_data(data.data(), data.size(), output, callbacks, error);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("bool try_load_file(const std::string& filePath, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks, xsd::error& error)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    xsdcpp::FileContent file;");
+                _cppOutputFinal.append("    return file.open(filePath, error) && try_load_data(file.data(), file.size(), output, callbacks, error);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("void load_data(const char* data, size_t length, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    xsd::error error;");
+                _cppOutputFinal.append("    if (!try_load_data(data, length, output, callbacks, error))");
+                _cppOutputFinal.append("        xsdcpp::throwError(error);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("void load_data(const std::string& data, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    load_data(data.data(), data.size(), output, callbacks);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+
+                _cppOutputFinal.append(String("void load_file(const std::string& filePath, ") + elementTypeCppName + "& output, const " + callbacksCppName + "& callbacks)");
+                _cppOutputFinal.append("{");
+                _cppOutputFinal.append("    xsd::error error;");
+                _cppOutputFinal.append("    if (!try_load_file(filePath, output, callbacks, error))");
+                _cppOutputFinal.append("        xsdcpp::throwError(error);");
+                _cppOutputFinal.append("}");
+                _cppOutputFinal.append("");
+            }
         }
 
 
@@ -247,6 +843,8 @@ public:
 private:
     const Xsd& _xsd;
     const List<String>& _externalNamespacePrefixes;
+    uint32 _flags;
+    usize _maxDepth;
 
     HashMap<String, String> _externalNamespaces;
 
@@ -262,11 +860,51 @@ private:
     HashSet<Xsd::Name> _generatedElementInfos2;
     HashSet<Xsd::Name> _generatedTypeSetters;
     HashSet<const Xsd::AttributeRef*> _generatedAttributeSetDefaultValueFunctions;
-    HashMap<const Xsd::AttributeRef*, uint64> _generatedAttributeTrackBits;
     HashSet<Xsd::Name> _requiredTypes;
+    HashMap<String, usize> _childElementInfoIndices; // of "_<Type>_Children[<index>]" in the generated code
     String _error;
 
 private:
+    // Makes the caller's intern table or a table for a single load current, if string attributes are interned.
+    void appendInternTableScope()
+    {
+        if (!(_flags & InternStringAttributesFlag))
+            return;
+        _cppOutputFinal.append("    xsd::intern_table internTable;");
+        _cppOutputFinal.append("    xsd::intern_table::scope internScope(xsd::intern_table::current() ? *xsd::intern_table::current() : internTable);");
+    }
+
+    // The type of string fields. In a view model, they refer to the input buffer.
+    String toStringCppType() const
+    {
+        return (_flags & ViewStringsFlag) ? String("xsd::string_view") : String("xsd::string");
+    }
+
+    String toSetStringFunctionName() const
+    {
+        return (_flags & ViewStringsFlag) ? String("xsdcpp::set_string_view") : String("xsdcpp::set_string");
+    }
+
+    bool isInternedAttribute(const Xsd::AttributeRef& attributeRef)
+    {
+        if (!(_flags & InternStringAttributesFlag) || (_flags & ViewStringsFlag))
+            return false;
+        // restrictions of string types (other than enumerations) are strings as well
+        return getRootType(attributeRef.typeName).kind == Xsd::Type::StringKind;
+    }
+
+    String toAnyAttributeCppType() const
+    {
+        return (_flags & InternStringAttributesFlag) ? String("xsd::interned_any_attribute") : String("xsd::any_attribute");
+    }
+
+    String toAttributeCppType(const Xsd::AttributeRef& attributeRef)
+    {
+        if (isInternedAttribute(attributeRef))
+            return String("xsd::interned_string");
+        return toCppTypeIdentifierWithNamespace2(attributeRef.typeName);
+    }
+
     String toCppTypeIdentifier2(const Xsd::Name& typeName)
     {
         HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(typeName);
@@ -276,7 +914,7 @@ private:
             if (type.kind == Xsd::Type::StringKind)
             {
                 if (compareXsName(typeName, "normalizedString") || compareXsName(typeName, "string") || compareXsName(typeName, "anyURI"))
-                    return String("xsd::string");
+                    return toStringCppType();
             }
 
             if (type.kind == Xsd::Type::BaseKind)
@@ -324,7 +962,7 @@ private:
     {
         String result = toCppTypeIdentifier2(typeName);
         if (result == "_root_t" ||
-            result == "xsd::string" || 
+            result == toStringCppType() ||
             result == "uint64_t" ||
             result == "int64_t" ||
             result == "uint32_t" ||
@@ -352,8 +990,8 @@ private:
     String toSetValueFunctionName(const Xsd::Name& typeName)
     {
         String cppName = toCppTypeIdentifier2(typeName);
-        if (cppName == "xsd::string")
-            return String("xsdcpp::set_string");
+        if (cppName == toStringCppType())
+            return toSetStringFunctionName() + "<" + cppName + ">";
         if (cppName == "uint64_t" ||
             cppName == "int64_t" ||
             cppName == "uint32_t" ||
@@ -367,6 +1005,242 @@ private:
         return toCppNamespacePrefix(typeName) + "::_set_" + cppName;
     }
 
+    // Collects the child elements of a type including the ones inherited from its base types. If a base
+    // type is defined in an external namespace, the lookup of its children is delegated to its ElementInfo.
+    void collectChildElements(const Xsd::Name& typeName, List<NameSwitchCase>& cases, String& externalBaseInfo)
+    {
+        for (Xsd::Name name = typeName; !name.name.isEmpty();)
+        {
+            HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(name);
+            if (it == _xsd.types.end() || it->kind != Xsd::Type::ElementKind)
+                break;
+            if (isNamespaceExternal(name.xsdNamespace))
+            {
+                externalBaseInfo = toCppNamespacePrefix(name) + "::_" + toCppTypeIdentifier2(name) + "_Info";
+                break;
+            }
+            const Xsd::Type& type = *it;
+            String children = String("_") + toCppTypeIdentifier2(name) + "_Children";
+            usize index = 0;
+            for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+            {
+                const Xsd::ElementRef& elementRef = *i;
+                const Xsd::Type& elementType = *_xsd.types.find(elementRef.typeName);
+                if (elementType.kind == Xsd::Type::SubstitutionGroupKind)
+                    for (List<Xsd::ElementRef>::Iterator i = elementType.elements.begin(), end = elementType.elements.end(); i != end; ++i)
+                        addNameSwitchCase(cases, i->name.name, String("&") + children + "[" + String::fromUInt64(index++) + "]");
+                else
+                    addNameSwitchCase(cases, elementRef.name.name, String("&") + children + "[" + String::fromUInt64(index++) + "]");
+            }
+            name = type.baseType;
+        }
+    }
+
+    // Collects an element and the elements that can occur within it for the event handler of a root element.
+    // Elements with the same name but different types are reported to overloads of the same handler function.
+    void collectElementEvents(const Xsd::ElementRef& elementRef, List<ElementEvent>& events)
+    {
+        HashSet<Xsd::Name> visitedTypes;
+        addElementEvent(events, elementRef.name.name, elementRef.typeName);
+        collectElementEvents(elementRef.typeName, visitedTypes, events);
+    }
+
+    void collectElementEvents(const Xsd::Name& typeName, HashSet<Xsd::Name>& visitedTypes, List<ElementEvent>& events)
+    {
+        for (Xsd::Name name = typeName; !name.name.isEmpty() && !visitedTypes.contains(name);)
+        {
+            visitedTypes.append(name);
+            HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(name);
+            if (it == _xsd.types.end() || it->kind != Xsd::Type::ElementKind)
+                break;
+            const Xsd::Type& type = *it;
+            for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+            {
+                const Xsd::ElementRef& elementRef = *i;
+                const Xsd::Type& elementType = *_xsd.types.find(elementRef.typeName);
+                if (elementType.kind == Xsd::Type::SubstitutionGroupKind)
+                    for (List<Xsd::ElementRef>::Iterator i = elementType.elements.begin(), end = elementType.elements.end(); i != end; ++i)
+                    {
+                        addElementEvent(events, i->name.name, i->typeName);
+                        collectElementEvents(i->typeName, visitedTypes, events);
+                    }
+                else
+                {
+                    addElementEvent(events, elementRef.name.name, elementRef.typeName);
+                    collectElementEvents(elementRef.typeName, visitedTypes, events);
+                }
+            }
+            name = type.baseType;
+        }
+    }
+
+    // Collects the child element infos through which a root element and the elements within it are passed to the
+    // event handler. Children of types in an external namespace are identified by their type and name instead.
+    void collectChildEvents(const Xsd::Type& rootType, const Xsd::ElementRef& elementRef, List<ChildEvent>& events)
+    {
+        usize index = 0;
+        for (List<Xsd::ElementRef>::Iterator i = rootType.elements.begin(), end = rootType.elements.end(); i != end && &*i != &elementRef; ++i)
+            ++index;
+        addChildEvent(events, String("_") + toCppTypeIdentifier2(_xsd.rootType) + "_Children[" + String::fromUInt64(index) + "]", elementRef.name.name, elementRef.typeName);
+        HashSet<Xsd::Name> visitedTypes;
+        collectChildEvents(elementRef.typeName, visitedTypes, events);
+    }
+
+    void collectChildEvents(const Xsd::Name& typeName, HashSet<Xsd::Name>& visitedTypes, List<ChildEvent>& events)
+    {
+        for (Xsd::Name name = typeName; !name.name.isEmpty() && !visitedTypes.contains(name);)
+        {
+            visitedTypes.append(name);
+            HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(name);
+            if (it == _xsd.types.end() || it->kind != Xsd::Type::ElementKind)
+                break;
+            const Xsd::Type& type = *it;
+            bool external = isNamespaceExternal(name.xsdNamespace);
+            String children = String("_") + toCppTypeIdentifier2(name) + "_Children";
+            usize index = 0;
+            for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+            {
+                const Xsd::ElementRef& elementRef = *i;
+                const Xsd::Type& elementType = *_xsd.types.find(elementRef.typeName);
+                if (elementType.kind == Xsd::Type::SubstitutionGroupKind)
+                    for (List<Xsd::ElementRef>::Iterator i = elementType.elements.begin(), end = elementType.elements.end(); i != end; ++i)
+                    {
+                        addChildEvent(events, external ? String() : children + "[" + String::fromUInt64(index) + "]", i->name.name, i->typeName);
+                        ++index;
+                        collectChildEvents(i->typeName, visitedTypes, events);
+                    }
+                else
+                {
+                    addChildEvent(events, external ? String() : children + "[" + String::fromUInt64(index) + "]", elementRef.name.name, elementRef.typeName);
+                    ++index;
+                    collectChildEvents(elementRef.typeName, visitedTypes, events);
+                }
+            }
+            name = type.baseType;
+        }
+    }
+
+    // Numbers the child element infos of the generated code, so that handler events can be dispatched with a switch.
+    usize addChildElementInfoIndex(const String& children, usize index)
+    {
+        usize childElementInfoIndex = _childElementInfoIndices.size();
+        _childElementInfoIndices.append(children + "[" + String::fromUInt64(index) + "]", childElementInfoIndex);
+        return childElementInfoIndex;
+    }
+
+    static void addChildEvent(List<ChildEvent>& events, const String& childInfo, const String& name, const Xsd::Name& typeName)
+    {
+        for (List<ChildEvent>::Iterator i = events.begin(), end = events.end(); i != end; ++i)
+            if (i->childInfo == childInfo && i->name == name && i->typeName == typeName)
+                return;
+        ChildEvent& event = events.append(ChildEvent());
+        event.childInfo = childInfo;
+        event.name = name;
+        event.typeName = typeName;
+    }
+
+    static void addElementEvent(List<ElementEvent>& events, const String& name, const Xsd::Name& typeName)
+    {
+        for (List<ElementEvent>::Iterator i = events.begin(), end = events.end(); i != end; ++i)
+            if (i->name == name && i->typeName == typeName)
+                return;
+        ElementEvent& event = events.append(ElementEvent());
+        event.name = name;
+        event.typeName = typeName;
+    }
+
+    // Collects the repeated child elements of the local types that can occur within an element of the given type.
+    // Each of them can be passed to a callback instead of being stored in the list of its parent element.
+    void collectRecordPaths(const Xsd::Name& typeName, HashSet<Xsd::Name>& visitedTypes, List<RecordPath>& paths)
+    {
+        if (typeName.name.isEmpty() || visitedTypes.contains(typeName) || isNamespaceExternal(typeName.xsdNamespace))
+            return;
+        visitedTypes.append(typeName);
+        HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(typeName);
+        if (it == _xsd.types.end() || it->kind != Xsd::Type::ElementKind)
+            return;
+        const Xsd::Type& type = *it;
+        String cppName = toCppTypeIdentifier2(typeName);
+        usize index = 0;
+        for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+        {
+            const Xsd::ElementRef& elementRef = *i;
+            const Xsd::Type& elementType = *_xsd.types.find(elementRef.typeName);
+            if (elementType.kind == Xsd::Type::SubstitutionGroupKind)
+                for (List<Xsd::ElementRef>::Iterator i = elementType.elements.begin(), end = elementType.elements.end(); i != end; ++i)
+                {
+                    if (elementRef.maxOccurs != 1)
+                        addRecordPath(paths, cppName + "_" + toCppFieldIdentifier(i->name), String("_") + cppName + "_Children[" + String::fromUInt64(index) + "]", i->typeName);
+                    ++index;
+                    collectRecordPaths(i->typeName, visitedTypes, paths);
+                }
+            else
+            {
+                if (elementRef.maxOccurs != 1)
+                    addRecordPath(paths, cppName + "_" + toCppFieldIdentifier(elementRef.name), String("_") + cppName + "_Children[" + String::fromUInt64(index) + "]", elementRef.typeName);
+                ++index;
+                collectRecordPaths(elementRef.typeName, visitedTypes, paths);
+            }
+        }
+        collectRecordPaths(type.baseType, visitedTypes, paths);
+    }
+
+    static void addRecordPath(List<RecordPath>& paths, const String& name, const String& childInfo, const Xsd::Name& typeName)
+    {
+        for (List<RecordPath>::Iterator i = paths.begin(), end = paths.end(); i != end; ++i)
+            if (i->name == name)
+                return;
+        RecordPath& path = paths.append(RecordPath());
+        path.name = name;
+        path.childInfo = childInfo;
+        path.typeName = typeName;
+    }
+
+    // Collects the attributes of a type including the ones inherited from its base types.
+    void collectAttributes(const Xsd::Name& typeName, List<NameSwitchCase>& cases, String& externalBaseInfo)
+    {
+        for (Xsd::Name name = typeName; !name.name.isEmpty();)
+        {
+            HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(name);
+            if (it == _xsd.types.end() || it->kind != Xsd::Type::ElementKind)
+                break;
+            if (isNamespaceExternal(name.xsdNamespace))
+            {
+                externalBaseInfo = toCppNamespacePrefix(name) + "::_" + toCppTypeIdentifier2(name) + "_Info";
+                break;
+            }
+            const Xsd::Type& type = *it;
+            String attributes = String("_") + toCppTypeIdentifier2(name) + "_Attributes";
+            usize index = 0;
+            for (List<Xsd::AttributeRef>::Iterator i = type.attributes.begin(), end = type.attributes.end(); i != end; ++i)
+                addNameSwitchCase(cases, i->name.name, String("&") + attributes + "[" + String::fromUInt64(index++) + "]");
+            name = type.baseType;
+        }
+    }
+
+    // Adds the namespace declarations and schema locations that are most likely to occur on a root element.
+    // Other prefixes are resolved by xsdcpp::findEntryPointAttribute.
+    void collectEntryPointAttributes(List<NameSwitchCase>& cases)
+    {
+        addNameSwitchCase(cases, String("xmlns"), String("&xsdcpp::namespaceAttribute"));
+        addNameSwitchCase(cases, String("xmlns:xsi"), String("&xsdcpp::namespaceAttribute"));
+        for (HashMap<String, String>::Iterator i = _xsd.namespaceToSuggestedPrefix.begin(), end = _xsd.namespaceToSuggestedPrefix.end(); i != end; ++i)
+            if (!i->isEmpty())
+                addNameSwitchCase(cases, String("xmlns:") + *i, String("&xsdcpp::namespaceAttribute"));
+        addNameSwitchCase(cases, String("xsi:schemaLocation"), String("&xsdcpp::schemaLocationAttribute"));
+        addNameSwitchCase(cases, String("xsi:noNamespaceSchemaLocation"), String("&xsdcpp::schemaLocationAttribute"));
+    }
+
+    static void addNameSwitchCase(List<NameSwitchCase>& cases, const String& name, const String& result)
+    {
+        for (List<NameSwitchCase>::Iterator i = cases.begin(), end = cases.end(); i != end; ++i)
+            if (i->name == name)
+                return; // shadowed by a derived type
+        NameSwitchCase& switchCase = cases.append(NameSwitchCase());
+        switchCase.name = name;
+        switchCase.result = result;
+    }
+
     usize getChildrenCount(const Xsd::Name& typeName) const
     {
         if (typeName.name.isEmpty())
@@ -378,7 +1252,9 @@ private:
         return type.elements.size() + getChildrenCount(type.baseType);
     }
 
-    usize getMandatoryChildrenCount(const Xsd::Name& typeName) const
+    // The children and attributes of a type are tracked with one bit each at the runtime. The bits of the
+    // base types come first, followed by the ones of the children and of the attributes of the type itself.
+    usize getTrackCount(const Xsd::Name& typeName) const
     {
         if (typeName.name.isEmpty())
             return 0;
@@ -386,17 +1262,16 @@ private:
         if (it == _xsd.types.end())
             return 0;
         const Xsd::Type& type = *it;
-        usize count = 0;
-        for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
-        {
-            const Xsd::ElementRef& elementRef = *i;
-            if (elementRef.minOccurs)
-                ++count;
-        }
-        return count + getMandatoryChildrenCount(type.baseType);
+        return type.elements.size() + type.attributes.size() + getTrackCount(type.baseType);
     }
 
-    usize getAttributesCount(const Xsd::Name& typeName) const
+    // Children that can occur more than once a limited number of times or that must occur more than once have an occurrence counter.
+    static bool isCounted(const Xsd::ElementRef& elementRef)
+    {
+        return elementRef.maxOccurs > 1 || elementRef.minOccurs > 1;
+    }
+
+    usize getCounterCount(const Xsd::Name& typeName) const
     {
         if (typeName.name.isEmpty())
             return 0;
@@ -404,23 +1279,55 @@ private:
         if (it == _xsd.types.end())
             return 0;
         const Xsd::Type& type = *it;
-        return type.attributes.size() + getAttributesCount(type.baseType);
+        usize count = 0;
+        for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+            if (isCounted(*i))
+                ++count;
+        return count + getCounterCount(type.baseType);
     }
 
-    uint64 getCheckAttributesMask(const Xsd::Name& typeName) const
+    // Collects the track indices of the children with a minimum occurrence and of the attributes that are mandatory or have a default value.
+    void collectCheckedTrackIndices(const Xsd::Name& typeName, List<usize>& requiredChildren, List<usize>& checkedAttributes, bool& checkMinOccurs) const
     {
         if (typeName.name.isEmpty())
-            return 0;
+            return;
         HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(typeName);
         if (it == _xsd.types.end())
-            return 0;
+            return;
         const Xsd::Type& type = *it;
-        uint64 result = getCheckAttributesMask(type.baseType);
-        for (List<Xsd::AttributeRef>::Iterator i = type.attributes.begin(), end = type.attributes.end(); i != end; ++i)
+        collectCheckedTrackIndices(type.baseType, requiredChildren, checkedAttributes, checkMinOccurs);
+        usize trackIndex = getTrackCount(type.baseType);
+        for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i, ++trackIndex)
+        {
+            const Xsd::ElementRef& elementRef = *i;
+            if (elementRef.minOccurs && _xsd.types.find(elementRef.typeName)->kind != Xsd::Type::SubstitutionGroupKind)
+            {
+                requiredChildren.append(trackIndex);
+                if (elementRef.minOccurs > 1)
+                    checkMinOccurs = true;
+            }
+        }
+        for (List<Xsd::AttributeRef>::Iterator i = type.attributes.begin(), end = type.attributes.end(); i != end; ++i, ++trackIndex)
         {
             const Xsd::AttributeRef& attribute = *i;
             if (attribute.isMandatory || _generatedAttributeSetDefaultValueFunctions.contains(&attribute))
-                result |= *_generatedAttributeTrackBits.find(&attribute);
+                checkedAttributes.append(trackIndex);
+        }
+    }
+
+    // Generates a bit mask with `trackCount` bits that are set for the given track indices.
+    static String toTrackMask(const List<usize>& trackIndices, usize trackCount)
+    {
+        String result;
+        for (usize word = 0; word * 64 < trackCount; ++word)
+        {
+            uint64 mask = 0;
+            for (List<usize>::Iterator i = trackIndices.begin(), end = trackIndices.end(); i != end; ++i)
+                if (*i / 64 == word)
+                    mask |= (uint64)1 << (*i % 64);
+            if (word)
+                result.append(", ");
+            result.append(String::fromUInt64(mask) + "ULL");
         }
         return result;
     }
@@ -520,6 +1427,38 @@ private:
         return defaultValue;
     }
 
+    // Checks whether an object of a type contains an object of another type (directly, in an optional field, or as
+    // a base type) that is not stored in a list. An optional field of such a type has to be stored on the heap to
+    // break the recursion.
+    bool containsType(const Xsd::Name& typeName, const Xsd::Name& containedTypeName, HashSet<Xsd::Name>& visited)
+    {
+        if (typeName == containedTypeName)
+            return true;
+        if (visited.contains(typeName))
+            return false;
+        visited.append(typeName);
+
+        HashMap<Xsd::Name, Xsd::Type>::Iterator it = _xsd.types.find(typeName);
+        if (it == _xsd.types.end())
+            return false;
+        const Xsd::Type& type = *it;
+        if (type.kind != Xsd::Type::ElementKind && type.kind != Xsd::Type::SubstitutionGroupKind)
+            return false;
+
+        if (type.kind == Xsd::Type::ElementKind && !type.baseType.name.isEmpty() && containsType(type.baseType, containedTypeName, visited))
+            return true;
+        for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
+            if ((type.kind == Xsd::Type::SubstitutionGroupKind || i->maxOccurs == 1) && containsType(i->typeName, containedTypeName, visited))
+                return true;
+        return false;
+    }
+
+    bool isRecursiveOptional(const Xsd::Name& typeName, const Xsd::Name& fieldTypeName)
+    {
+        HashSet<Xsd::Name> visited;
+        return containsType(fieldTypeName, typeName, visited);
+    }
+
     bool collectLocalTypes(const Xsd::Name& typeName, HashSet<Xsd::Name>& elementTypes, HashSet<Xsd::Name>& substitutionGroupTypes)
     {
         if (isNamespaceExternal(typeName.xsdNamespace))
@@ -699,7 +1638,7 @@ private:
             return true;
 
         String cppName = toCppTypeIdentifier2(typeName);
-        if (cppName == "xsd::string" ||
+        if (cppName == toStringCppType() ||
             cppName == "uint64_t" ||
             cppName == "int64_t" ||
             cppName == "uint32_t" ||
@@ -722,11 +1661,11 @@ private:
                 return true; // you don't need a setter for such an element
             if (!generateTypeSetter(baseTypeName))
                 return false;
-            _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { " + toCppTypeIdentifierWithNamespace2(baseTypeName) + "& base = *obj; " + toSetValueFunctionName(baseTypeName) + "(&base, pos, std::move(val)); }");
+            _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { " + toCppTypeIdentifierWithNamespace2(baseTypeName) + "& base = *obj; return " + toSetValueFunctionName(baseTypeName) + "(&base, data, length); }");
 
         }
         else if (type.kind == Xsd::Type::Kind::StringKind || type.kind == Xsd::Type::Kind::UnionKind)
-            _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { xsdcpp::set_string(obj, pos, std::move(val)); }");
+            _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { return " + toSetStringFunctionName() + "(obj, data, length); }");
         else if (type.kind == Xsd::Type::Kind::ListKind)
         {
             const Xsd::Name& itemTypeName = type.baseType;
@@ -734,19 +1673,19 @@ private:
                 return false;
             Xsd::Type itemType = getType(itemTypeName);
              if (itemType.kind == Xsd::Type::Kind::StringKind || itemType.kind == Xsd::Type::Kind::UnionKind)
-                _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { const char* s = val.c_str(); std::string item; while (xsdcpp::getListItem(s, item)) { obj->emplace_back(std::move(item)); } }");
+                _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { const char* end = data + length; const char* item; size_t itemLength; while (xsdcpp::getListItem(data, end, item, itemLength)) { obj->emplace_back(item, itemLength); } return xsd::error::none; }");
             else
-                _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { const char* s = val.c_str(); std::string item; while (xsdcpp::getListItem(s, item)) { obj->emplace_back(); " + toSetValueFunctionName(itemTypeName) + "(&obj->back(), pos, std::move(item)); } }");
+                _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { const char* end = data + length; const char* item; size_t itemLength; while (xsdcpp::getListItem(data, end, item, itemLength)) { obj->emplace_back(); if (xsd::error::code_t code = " + toSetValueFunctionName(itemTypeName) + "(&obj->back(), item, itemLength)) return code; } return xsd::error::none; }");
         }
         else if (type.kind == Xsd::Type::Kind::EnumKind)
         {
-            _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { *obj = (" + cppNameWithNamespace + ")xsdcpp::toNumeric(pos, _" + cppName + "_Values, val); }");
+            _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { return xsdcpp::set_enum(obj, &_find_enum_" + cppName + ", data, length); }");
         }
         else
         {
             if (!generateTypeSetter(type.baseType))
                 return false;
-            _cppOutputNamespaceSetValue.append(String("void ") + functionName + "(" + cppNameWithNamespace + "* obj, const xsdcpp::Position& pos, std::string&& val) { " + toSetValueFunctionName(type.baseType)  + "(obj, pos, std::move(val)); }");
+            _cppOutputNamespaceSetValue.append(String("xsd::error::code_t ") + functionName + "(" + cppNameWithNamespace + "* obj, const char* data, size_t length) { return " + toSetValueFunctionName(type.baseType)  + "(obj, data, length); }");
         }
         
         return true;
@@ -903,7 +1842,7 @@ private:
         {
             _generatedTypes2.append(typeName);
             String cppName = toCppTypeIdentifier2(typeName);
-            _hppOutput.append(String("typedef xsd::string ") + cppName + ";");
+            _hppOutput.append(String("typedef ") + toStringCppType() + " " + cppName + ";");
             _hppOutput.append("");
             return true;
         }
@@ -936,6 +1875,7 @@ private:
             _hppOutput.append("};");
             _hppOutput.append("");
             _hppOutput.append(String("std::string to_string(") + cppName + ");");
+            _hppOutput.append(String("const char* to_cstring(") + cppName + ");");
             _hppOutput.append("");
 
             _cppOutputAnonymousEnumValues.append(String("const char* _") + cppName + "_Values[] = {");
@@ -943,7 +1883,21 @@ private:
                 _cppOutputAnonymousEnumValues.append(String("    \"") + *i + "\",");
             _cppOutputAnonymousEnumValues.append("    nullptr};");
             _cppOutputAnonymousEnumValues.append("");
-            _cppOutputNamespaceSetValue.append(String("std::string to_string(") + cppName + " val) { return xsdcpp::to_string((size_t)val, " + String::fromUInt64(type.enumEntries.size()) +  ", _" + cppName + "_Values, " + toCStringLiteral(cppName) + "); }");
+
+            List<NameSwitchCase> cases;
+            usize index = 0;
+            for (List<String>::Iterator i = type.enumEntries.begin(), end = type.enumEntries.end(); i != end; ++i)
+                addNameSwitchCase(cases, *i, String::fromUInt64(index++));
+            _cppOutputAnonymousEnumValues.append(String("int _find_enum_") + cppName + "(const char* name, size_t length)");
+            _cppOutputAnonymousEnumValues.append("{");
+            if (!cases.isEmpty())
+                generateNameSwitch(cases, "    ", _cppOutputAnonymousEnumValues);
+            _cppOutputAnonymousEnumValues.append("    return -1;");
+            _cppOutputAnonymousEnumValues.append("}");
+            _cppOutputAnonymousEnumValues.append("");
+
+            _cppOutputNamespaceSetValue.append(String("std::string to_string(") + cppName + " val) { return xsdcpp::to_cstring((size_t)val, " + String::fromUInt64(type.enumEntries.size()) +  ", _" + cppName + "_Values, " + toCStringLiteral(cppName) + "); }");
+            _cppOutputNamespaceSetValue.append(String("const char* to_cstring(") + cppName + " val) { return xsdcpp::to_cstring((size_t)val, " + String::fromUInt64(type.enumEntries.size()) +  ", _" + cppName + "_Values, " + toCStringLiteral(cppName) + "); }");
 
             return true;
         }
@@ -957,9 +1911,10 @@ private:
             for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
             {
                 const Xsd::ElementRef& elementRef = *i;
-                if (!processType2(elementRef.typeName, level + 1, false))
+                bool recursive = isRecursiveOptional(typeName, elementRef.typeName);
+                if (!processType2(elementRef.typeName, level + 1, !recursive))
                     return false;
-                structFields.append(String("xsd::optional<") + toCppTypeIdentifierWithNamespace2(elementRef.typeName) + "> " + toCppFieldIdentifier(elementRef.name));
+                structFields.append(String(recursive ? "xsd::boxed_optional<" : "xsd::optional<") + toCppTypeIdentifierWithNamespace2(elementRef.typeName) + "> " + toCppFieldIdentifier(elementRef.name));
             }
 
             List<String> structDefintiion;
@@ -982,15 +1937,16 @@ private:
 
             Xsd::Type* baseType = nullptr;
             usize nextChildElementTrackIndex = 0;
-            usize nextAttributeTrackIndex = 0;
+            usize nextCounterIndex = 0;
             if (!type.baseType.name.isEmpty())
             {
                 if (!processType2(type.baseType, level + 1, true))
                     return false;
                 baseType = &*_xsd.types.find(type.baseType);
-                nextChildElementTrackIndex = getChildrenCount(type.baseType);
-                nextAttributeTrackIndex = getAttributesCount(type.baseType);
+                nextChildElementTrackIndex = getTrackCount(type.baseType);
+                nextCounterIndex = getCounterCount(type.baseType);
             }
+            usize nextAttributeTrackIndex = nextChildElementTrackIndex + type.elements.size();
 
             List<String> structFields;
             for (List<Xsd::AttributeRef>::Iterator i = type.attributes.begin(), end = type.attributes.end(); i != end; ++i)
@@ -1000,22 +1956,23 @@ private:
                 if (!processType2(attributeRef.typeName, level + 1, !optionalWithoutDefaultValue))
                     return false;
                 if (optionalWithoutDefaultValue)
-                    structFields.append(String("xsd::optional<") + toCppTypeIdentifierWithNamespace2(attributeRef.typeName) + "> " + toCppFieldIdentifier(attributeRef.name));
+                    structFields.append(String("xsd::optional<") + toAttributeCppType(attributeRef) + "> " + toCppFieldIdentifier(attributeRef.name));
                 else
-                    structFields.append(toCppTypeIdentifierWithNamespace2(attributeRef.typeName) + " " + toCppFieldIdentifier(attributeRef.name));
+                    structFields.append(toAttributeCppType(attributeRef) + " " + toCppFieldIdentifier(attributeRef.name));
             }
             if (type.flags & Xsd::Type::AnyAttributeFlag)
-                structFields.append("xsd::vector<xsd::any_attribute> other_attributes");
+                structFields.append(String("xsd::vector<") + toAnyAttributeCppType() + "> other_attributes");
             for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
             {
                 const Xsd::ElementRef& elementRef = *i;
-                bool typeDefinitionRequired = elementRef.minOccurs == 1 && elementRef.maxOccurs == 1;
+                bool recursive = elementRef.minOccurs != 1 && elementRef.maxOccurs == 1 && isRecursiveOptional(typeName, elementRef.typeName);
+                bool typeDefinitionRequired = elementRef.maxOccurs == 1 && !recursive;
                 if (!processType2(elementRef.typeName, level + 1, typeDefinitionRequired))
                     return false;
                 if (elementRef.minOccurs == 1 && elementRef.maxOccurs == 1)
                     structFields.append(toCppTypeIdentifierWithNamespace2(elementRef.typeName) + " " + toCppFieldIdentifier(elementRef.name));
                 else if (elementRef.maxOccurs == 1)
-                    structFields.append(String("xsd::optional<") + toCppTypeIdentifierWithNamespace2(elementRef.typeName) + "> " + toCppFieldIdentifier(elementRef.name));
+                    structFields.append(String(recursive ? "xsd::boxed_optional<" : "xsd::optional<") + toCppTypeIdentifierWithNamespace2(elementRef.typeName) + "> " + toCppFieldIdentifier(elementRef.name));
                 else
                     structFields.append(String("xsd::vector<") + toCppTypeIdentifierWithNamespace2(elementRef.typeName) + "> " + toCppFieldIdentifier(elementRef.name));
             }
@@ -1047,6 +2004,11 @@ private:
                 const Xsd::ElementRef& elementRef = *i;
                 if (!processType2(elementRef.typeName, level + 1, false))
                     return false;
+                if (elementRef.maxOccurs != 1)
+                {
+                    _cppOutputAnonymousFieldGetter.append(String("void _remove_") + cppName + "_" + toCppFieldIdentifier(elementRef.name) + "(" + cppNameWithNamespace + "* parent) {parent->" + toCppFieldIdentifier(elementRef.name) + ".pop_back();}");
+                    _cppOutputAnonymousFieldGetter.append(String("void _append_") + cppName + "_" + toCppFieldIdentifier(elementRef.name) + "(" + cppNameWithNamespace + "* parent, " + cppNameWithNamespace + "* other) {xsdcpp::appendList(parent->" + toCppFieldIdentifier(elementRef.name) + ", other->" + toCppFieldIdentifier(elementRef.name) + ");}");
+                }
                 const Xsd::Type& type = *_xsd.types.find(elementRef.typeName);
                 if (type.kind == Xsd::Type::SubstitutionGroupKind)
                 {
@@ -1081,6 +2043,7 @@ private:
                 children = String("_") + cppName + "_Children";
                 List<String> childElementInfo;
                 childElementInfo.append(String("xsdcpp::ChildElementInfo _") + cppName + "_Children[] = {");
+                usize index = 0;
                 for (List<Xsd::ElementRef>::Iterator i = type.elements.begin(), end = type.elements.end(); i != end; ++i)
                 {
                     const Xsd::ElementRef& elementRef = *i;
@@ -1088,6 +2051,16 @@ private:
                         return false;
 
                     usize trackIndex = nextChildElementTrackIndex++;
+                    String counterIndex("xsdcpp::ChildElementInfo::noCounter");
+                    if (isCounted(elementRef))
+                        counterIndex = String::fromUInt64(nextCounterIndex++);
+                    String removeField("nullptr");
+                    String appendField("nullptr");
+                    if (elementRef.maxOccurs != 1)
+                    {
+                        removeField = String("(xsdcpp::remove_field_t)&_remove_") + cppName + "_" + toCppFieldIdentifier(elementRef.name);
+                        appendField = String("(xsdcpp::append_field_t)&_append_") + cppName + "_" + toCppFieldIdentifier(elementRef.name);
+                    }
 
                     const Xsd::Type& type = *_xsd.types.find(elementRef.typeName);
                     if (type.kind == Xsd::Type::SubstitutionGroupKind)
@@ -1101,7 +2074,8 @@ private:
                             if (!generateElementInfo(subElementRef.typeName))
                                 return false;
 
-                            childElementInfo.append(String("    {\"") + subElementRef.name.name + "\", " + String::fromUInt((uint)trackIndex) + ", (xsdcpp::get_field_t)&_get_" + cppName +  "_" + toCppFieldIdentifier(elementRef.name) + "_" + toCppFieldIdentifier(subElementRef.name) + ", &" + toCppNamespacePrefix(subElementRef.typeName) + "::_" + toCppTypeIdentifier2(subElementRef.typeName) + "_Info, 0, " + String::fromUInt(elementRef.maxOccurs)  + "},");
+                            usize handlerEvent = addChildElementInfoIndex(children, index++);
+                            childElementInfo.append(String("    {\"") + subElementRef.name.name + "\", " + String::fromUInt64(trackIndex) + ", " + counterIndex + ", (xsdcpp::get_field_t)&_get_" + cppName +  "_" + toCppFieldIdentifier(elementRef.name) + "_" + toCppFieldIdentifier(subElementRef.name) + ", &" + toCppNamespacePrefix(subElementRef.typeName) + "::_" + toCppTypeIdentifier2(subElementRef.typeName) + "_Info, 0, " + String::fromUInt(elementRef.maxOccurs)  + ", " + removeField + ", " + appendField + ", " + String::fromUInt64(handlerEvent) + "},");
                         }
                     }
                     else
@@ -1109,13 +2083,34 @@ private:
                         if (!generateElementInfo(elementRef.typeName))
                             return false;
 
-                        childElementInfo.append(String("    {\"") + elementRef.name.name + "\", " + String::fromUInt((uint)trackIndex) + ", (xsdcpp::get_field_t)&_get_" + cppName + "_" + toCppFieldIdentifier(elementRef.name) + ", &" + toCppNamespacePrefix(elementRef.typeName) + "::_" + toCppTypeIdentifier2(elementRef.typeName) + "_Info, " + String::fromUInt(elementRef.minOccurs)  + ", " + String::fromUInt(elementRef.maxOccurs)  + "},");
+                        usize handlerEvent = addChildElementInfoIndex(children, index++);
+                        childElementInfo.append(String("    {\"") + elementRef.name.name + "\", " + String::fromUInt64(trackIndex) + ", " + counterIndex + ", (xsdcpp::get_field_t)&_get_" + cppName + "_" + toCppFieldIdentifier(elementRef.name) + ", &" + toCppNamespacePrefix(elementRef.typeName) + "::_" + toCppTypeIdentifier2(elementRef.typeName) + "_Info, " + String::fromUInt(elementRef.minOccurs)  + ", " + String::fromUInt(elementRef.maxOccurs)  + ", " + removeField + ", " + appendField + ", " + String::fromUInt64(handlerEvent) + "},");
                     }
                 }
                 childElementInfo.append("    {nullptr}\n};");
                 _cppOutputAnonymousFieldGetter.append(childElementInfo);
             }
 
+            String findChild("nullptr");
+            {
+                List<NameSwitchCase> cases;
+                String externalBaseInfo;
+                collectChildElements(typeName, cases, externalBaseInfo);
+                if (!cases.isEmpty() || !externalBaseInfo.isEmpty())
+                {
+                    findChild = String("&_find_child_") + cppName;
+                    _cppOutputAnonymousFieldGetter.append(String("const xsdcpp::ChildElementInfo* _find_child_") + cppName + "(const char* name, size_t length)");
+                    _cppOutputAnonymousFieldGetter.append("{");
+                    if (!cases.isEmpty())
+                        generateNameSwitch(cases, "    ", _cppOutputAnonymousFieldGetter);
+                    if (externalBaseInfo.isEmpty())
+                        _cppOutputAnonymousFieldGetter.append("    return nullptr;");
+                    else
+                        _cppOutputAnonymousFieldGetter.append(String("    return ") + externalBaseInfo + ".findChild ? " + externalBaseInfo + ".findChild(name, length) : nullptr;");
+                    _cppOutputAnonymousFieldGetter.append("}");
+                }
+            }
+
             for (List<Xsd::AttributeRef>::Iterator i = type.attributes.begin(), end = type.attributes.end(); i != end; ++i)
             {
                 const Xsd::AttributeRef& attributeRef = *i;
@@ -1132,7 +2127,7 @@ private:
 
                 bool optionalWithoutDefaultValue = !attributeRef.isMandatory && attributeRef.defaultValue.isNull();
                 if (optionalWithoutDefaultValue)
-                    _cppOutputAnonymousFieldGetter.append(String("void* _get_") + cppName + "_" + toCppFieldIdentifier(attributeRef.name) + "(" + toCppTypeIdentifierWithNamespace2(typeName) + "* elem) { return &*(elem->" + toCppFieldIdentifier(attributeRef.name) + " = " + toCppTypeIdentifierWithNamespace2(attributeRef.typeName) + "()); }");
+                    _cppOutputAnonymousFieldGetter.append(String("void* _get_") + cppName + "_" + toCppFieldIdentifier(attributeRef.name) + "(" + toCppTypeIdentifierWithNamespace2(typeName) + "* elem) { return &*(elem->" + toCppFieldIdentifier(attributeRef.name) + " = " + toAttributeCppType(attributeRef) + "()); }");
                 else
                     _cppOutputAnonymousFieldGetter.append(String("void* _get_") + cppName + "_" + toCppFieldIdentifier(attributeRef.name) + "(" + toCppTypeIdentifierWithNamespace2(typeName) + "* elem) { return &elem->" + toCppFieldIdentifier(attributeRef.name) + "; }");
 
@@ -1148,7 +2143,7 @@ private:
                 }
             }
             if (type.flags & Xsd::Type::AnyAttributeFlag)
-                _cppOutputAnonymousFieldGetter.append(String("void _any_") + cppName + "(" + toCppTypeIdentifierWithNamespace2(typeName) + "* element, std::string&& name, std::string&& value) { element->other_attributes.emplace_back(xsd::any_attribute{std::move(name), std::move(value)}); }");
+                _cppOutputAnonymousFieldGetter.append(String("void _any_") + cppName + "(" + toCppTypeIdentifierWithNamespace2(typeName) + "* element, std::string&& name, std::string&& value) { element->other_attributes.emplace_back(" + toAnyAttributeCppType() + "{std::move(name), std::move(value)}); }");
 
             String attributes("nullptr");
             if (!type.attributes.isEmpty())
@@ -1162,29 +2157,71 @@ private:
                         return false;
 
                     usize trackIndex = nextAttributeTrackIndex++;
-                    uint64 trackBit = (uint64)1 << trackIndex;
-
-                    _generatedAttributeTrackBits.append(&attributeRef, trackBit);
 
                     String setDefault("nullptr");
                     if (_generatedAttributeSetDefaultValueFunctions.contains(&attributeRef))
                         setDefault = String("(xsdcpp::set_default_t)&_default_") + cppName + "_" + toCppFieldIdentifier(attributeRef.name);
-                    _cppOutputAnonymousFieldGetter.append(String("    {\"") + attributeRef.name.name + "\", " + String::fromUInt64(trackBit) + "ULL, (xsdcpp::get_field_t)&_get_" + cppName + "_" + toCppFieldIdentifier(attributeRef.name) + ", (xsdcpp::set_value_t)&" + toSetValueFunctionName(attributeRef.typeName) + ", " + (attributeRef.isMandatory ? String("true") : String("false")) +  ", " + setDefault + "},");
+                    _cppOutputAnonymousFieldGetter.append(String("    {\"") + attributeRef.name.name + "\", " + String::fromUInt64(trackIndex) + ", (xsdcpp::get_field_t)&_get_" + cppName + "_" + toCppFieldIdentifier(attributeRef.name) + ", (xsdcpp::set_value_t)&" + (isInternedAttribute(attributeRef) ? String("xsdcpp::set_interned_string<xsd::interned_string>") : toSetValueFunctionName(attributeRef.typeName)) + ", " + (attributeRef.isMandatory ? String("true") : String("false")) +  ", " + setDefault + "},");
                 }
                 _cppOutputAnonymousFieldGetter.append("    {nullptr}\n};");
             }
 
-            usize childrenCount = getChildrenCount(typeName);
-            usize mandatoryChildrenCount = getMandatoryChildrenCount(typeName);
-            uint64 attributesCount = getAttributesCount(typeName);
-            uint64 checkAttributesMask = getCheckAttributesMask(typeName);
+            String findAttribute("nullptr");
+            {
+                List<NameSwitchCase> cases;
+                String externalBaseInfo;
+                collectAttributes(typeName, cases, externalBaseInfo);
+                if (level == 1)
+                    collectEntryPointAttributes(cases);
+                if (!cases.isEmpty() || !externalBaseInfo.isEmpty())
+                {
+                    findAttribute = String("&_find_attribute_") + cppName;
+                    _cppOutputAnonymousFieldGetter.append(String("const xsdcpp::AttributeInfo* _find_attribute_") + cppName + "(const char* name, size_t length)");
+                    _cppOutputAnonymousFieldGetter.append("{");
+                    if (!cases.isEmpty())
+                        generateNameSwitch(cases, "    ", _cppOutputAnonymousFieldGetter);
+                    if (level == 1)
+                    {
+                        if (!externalBaseInfo.isEmpty())
+                        {
+                            _cppOutputAnonymousFieldGetter.append(String("    if (") + externalBaseInfo + ".findAttribute)");
+                            _cppOutputAnonymousFieldGetter.append(String("        if (const xsdcpp::AttributeInfo* attribute = ") + externalBaseInfo + ".findAttribute(name, length))");
+                            _cppOutputAnonymousFieldGetter.append("            return attribute;");
+                        }
+                        _cppOutputAnonymousFieldGetter.append("    return xsdcpp::findEntryPointAttribute(name, length);");
+                    }
+                    else if (externalBaseInfo.isEmpty())
+                        _cppOutputAnonymousFieldGetter.append("    return nullptr;");
+                    else
+                        _cppOutputAnonymousFieldGetter.append(String("    return ") + externalBaseInfo + ".findAttribute ? " + externalBaseInfo + ".findAttribute(name, length) : nullptr;");
+                    _cppOutputAnonymousFieldGetter.append("}");
+                }
+            }
+
+            usize trackCount = getTrackCount(typeName);
+            List<usize> requiredChildren;
+            List<usize> checkedAttributes;
+            bool checkMinOccurs = false;
+            collectCheckedTrackIndices(typeName, requiredChildren, checkedAttributes, checkMinOccurs);
+            String requiredChildrenMask("nullptr");
+            if (!requiredChildren.isEmpty())
+            {
+                requiredChildrenMask = String("_") + cppName + "_RequiredChildren";
+                _cppOutputAnonymousFieldGetter.append(String("const uint64_t _") + cppName + "_RequiredChildren[] = {" + toTrackMask(requiredChildren, trackCount) + "};");
+            }
+            String checkedAttributesMask("nullptr");
+            if (!checkedAttributes.isEmpty())
+            {
+                checkedAttributesMask = String("_") + cppName + "_CheckAttributes";
+                _cppOutputAnonymousFieldGetter.append(String("const uint64_t _") + cppName + "_CheckAttributes[] = {" + toTrackMask(checkedAttributes, trackCount) + "};");
+            }
             List<String> flags;
             if (level == 1)
                 flags.append("xsdcpp::ElementInfo::EntryPointFlag");
             if (type.flags & Xsd::Type::AnyAttributeFlag)
                 flags.append("xsdcpp::ElementInfo::AnyAttributeFlag");
-            if (mandatoryChildrenCount)
-                flags.append("xsdcpp::ElementInfo::CheckChildrenFlag");
+            if (checkMinOccurs)
+                flags.append("xsdcpp::ElementInfo::CheckMinOccursFlag");
 
             String addTextFunction;
             if (!generateAddTextFunction2(typeName, flags, addTextFunction))
@@ -1200,10 +2237,12 @@ private:
 
             _cppOutputNamespace.append(String("const xsdcpp::ElementInfo _") + cppName + "_Info = { " + flagsStr 
                 + ", " + addTextFunction
-                + ", " + children + ", " + String::fromUInt64(childrenCount)
-                + ", " + attributes + ", " + String::fromUInt64(checkAttributesMask) + "ULL"
+                + ", " + children + ", " + String::fromUInt64(trackCount) + ", " + String::fromUInt64(getCounterCount(typeName))
+                + ", " + attributes + ", " + requiredChildrenMask + ", " + checkedAttributesMask
                 + ", " + (parentElementCppName.isEmpty() ? String("nullptr") : String("&") + toCppNamespacePrefix(type.baseType) + "::_" + parentElementCppName + "_Info") 
                 + ", " + (type.flags & Xsd::Type::AnyAttributeFlag ? String("(xsdcpp::set_any_attribute_t)&_any_") + cppName : String("nullptr"))
+                + ", " + findChild
+                + ", " + findAttribute
                 + " };");
 
             _generatedElementInfos2.append(typeName);
@@ -1217,11 +2256,11 @@ private:
 
 }
 
-bool generateCpp(const Xsd& xsd, const String& outputDir, const List<String>& excludedNamespacePrefixes, const List<String>& forceTypeProcessing, String& error)
+bool generateCpp(const Xsd& xsd, const String& outputDir, const List<String>& excludedNamespacePrefixes, const List<String>& forceTypeProcessing, uint32 flags, usize maxDepth, String& error)
 {
     List<String> cppOutput;
     List<String> hppOutput;
-    Generator generator(xsd, excludedNamespacePrefixes, forceTypeProcessing, cppOutput, hppOutput);
+    Generator generator(xsd, excludedNamespacePrefixes, forceTypeProcessing, flags, maxDepth, cppOutput, hppOutput);
     if (!generator.process())
         return (error = generator.getError()), false;
 
@@ -1244,6 +2283,9 @@ bool generateCpp(const Xsd& xsd, const String& outputDir, const List<String>& ex
         if (!outputFile.open(outputFilePath, File::writeFlag))
             return (error = String::fromPrintf("Could not open file '%s': %s", (const char*)outputFilePath, (const char*)Error::getErrorString())), false;
 
+        // the runtime uses xsd::error from the header
+        if (!outputFile.write(String("\n#include \"") + cppName + ".hpp\"\n\n"))
+            return (error = String::fromPrintf("Could not write to file '%s': %s", (const char*)outputFilePath, (const char*)Error::getErrorString())), false;
         if (!outputFile.write(XmlParser_hpp))
             return (error = String::fromPrintf("Could not write to file '%s': %s", (const char*)outputFilePath, (const char*)Error::getErrorString())), false;
         if (excludedNamespacePrefixes.isEmpty())
@@ -3,4 +3,10 @@
 
 #include "Reader.hpp"
 
-bool generateCpp(const Xsd& xsd, const String& outputDir, const List<String>& externalNamespacePrefixes, const List<String>& forceTypeProcessing, String& error);
+enum GeneratorFlags
+{
+    InternStringAttributesFlag = 1,
+    ViewStringsFlag = 2,
+};
+
+bool generateCpp(const Xsd& xsd, const String& outputDir, const List<String>& externalNamespacePrefixes, const List<String>& forceTypeProcessing, uint32 flags, usize maxDepth, String& error);
@@ -2,6 +2,9 @@
 #include <nstd/Process.hpp>
 #include <nstd/Console.hpp>
 
+#include <cstdlib>
+#include <cstring>
+
 #include "Reader.hpp"
 #include "Generator.hpp"
 
@@ -37,6 +40,19 @@ Options:\n\
         level. However, some additional types might be needed if they are\n\
         referenced from another schema that is based on the input schema. The\n\
         option '-t' can be used to enforce the generation of such types.\n\
+\n\
+    -d <depth>, --max-depth=<depth>\n\
+        The maximum number of nested elements in a document. Documents with\n\
+        deeper nested elements are rejected. The default, 0, means no limit.\n\
+\n\
+    -i, --intern\n\
+        Store string attributes as 'xsd::interned_string' handles. Equal values\n\
+        that are read during the same load share a single copy.\n\
+\n\
+    -v, --view\n\
+        Generate a view model, in which string fields are 'xsd::string_view'\n\
+        references into the input buffer. The model is loaded with 'load_view'\n\
+        from a mutable buffer, which has to outlive the model.\n\
 \n\
 ", VERSION);
 }
@@ -48,6 +64,8 @@ int main(int argc, char* argv[])
     String name;
     List<String> externalNamespacePrefixes;
     List<String> forceTypeProcessing;
+    uint32 flags = 0;
+    usize maxDepth = 0;
     {
         Process::Option options[] = {
             {'o', "output", Process::argumentFlag},
@@ -55,6 +73,9 @@ int main(int argc, char* argv[])
             {'h', "help", Process::optionFlag},
             {'e', "extern", Process::argumentFlag},
             {'t', "type", Process::argumentFlag},
+            {'d', "max-depth", Process::argumentFlag},
+            {'i', "intern", Process::optionFlag},
+            {'v', "view", Process::optionFlag},
             {1000, "version", Process::optionFlag},
         };
         Process::Arguments arguments(argc, argv, options);
@@ -75,6 +96,23 @@ int main(int argc, char* argv[])
             case 't':
                 forceTypeProcessing.append(argument);
                 break;
+            case 'd':
+            {
+                const char* depth = argument;
+                if (!*depth || depth[strspn(depth, "0123456789")])
+                {
+                    Console::errorf("Option d requires a number as argument, but got '%s'.\n", depth);
+                    return 1;
+                }
+                maxDepth = (usize)strtoull(depth, nullptr, 10);
+                break;
+            }
+            case 'i':
+                flags |= InternStringAttributesFlag;
+                break;
+            case 'v':
+                flags |= ViewStringsFlag;
+                break;
             case ':':
                 Console::errorf("Option %s required an argument.\n", (const char*)argument);
                 return 1;
@@ -98,7 +136,7 @@ int main(int argc, char* argv[])
     String error;
     Xsd xsd;
     if (!readXsd(name, inputFile, forceTypeProcessing, xsd, error) ||
-        !generateCpp(xsd, outputDir, externalNamespacePrefixes, forceTypeProcessing, error))
+        !generateCpp(xsd, outputDir, externalNamespacePrefixes, forceTypeProcessing, flags, maxDepth, error))
     {
         Console::errorf("error: %s\n", (const char*)error);
         return 1;
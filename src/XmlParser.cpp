@@ -1,28 +1,49 @@
-
 #include <cstring>
-#include <sstream>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <stdexcept>
+#include <limits>
+#include <locale.h>
+#include <cfloat>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
 
-namespace xsdcpp {
-
-ElementContext::ElementContext(const ElementInfo* info, void* element)
-    : info(info)
-    , element(element)
-    , processedAttributes2(0)
-{
-    memset(processedElements2, 0, sizeof(size_t) * info->childrenCount);
-}
-
-struct Position
-{
-    int line;
-    const char* pos;
-    const char* lineStart;
-};
-
-}
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XSDCPP_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define XSDCPP_AVX2
+#define XSDCPP_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define XSDCPP_AVX2
+#define XSDCPP_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
 
 namespace {
 
@@ -40,238 +61,616 @@ struct Token
     };
 
     Type type;
-    std::string value;
-    xsdcpp::Position pos;
+    const char* value; // name or raw (escaped) string in the input buffer
+    size_t length;
+    const char* pos;
+};
+
+struct Location // of a position in the document, computed on demand by counting the new lines in front of it
+{
+    uint64_t line;
+    uint64_t column; // in bytes
+};
+
+enum ScanLevel
+{
+    scalarScanLevel,
+    sse2ScanLevel,
+    avx2ScanLevel,
+};
+
+struct Frame
+{
+    xsdcpp::ElementContext elementContext;
+    const xsdcpp::ChildElementInfo* childInfo; // nullptr for the root type
+    size_t nameOffset; // element name in Context::names
+    size_t nameLength;
+    size_t trackOffset; // tracking bits of the children and attributes in Context::trackBits
+    size_t counterOffset; // occurrence counters of the children in Context::counters
+    bool textRead; // the text in front of the next tag has been processed
+
+    Frame(const xsdcpp::ElementInfo* info, void* element, const xsdcpp::ChildElementInfo* childInfo, size_t nameOffset, size_t nameLength, size_t trackOffset, size_t counterOffset)
+        : elementContext(info, element)
+        , childInfo(childInfo)
+        , nameOffset(nameOffset)
+        , nameLength(nameLength)
+        , trackOffset(trackOffset)
+        , counterOffset(counterOffset)
+        , textRead(false)
+    {
+    }
 };
 
 struct Context
 {
-    xsdcpp::Position pos;
+    const char* pos;
+    const char* end;
+    bool final; // no more input follows `end`
+    ScanLevel scanLevel;
     Token token;
     const char** namespaces;
+    xsdcpp::ElementHandler* handler;
+    const char* stopAt; // stop in front of the next tag in the document element that is at or behind this position, or in front of its end tag
+    size_t maxDepth; // maximum number of nested elements or 0
+    std::string buffer; // reused for unescaped attribute values and text
+    std::vector<Frame> stack; // open elements, starting with the root type
+    std::string names; // names of the open elements
+    std::vector<uint64_t> trackBits; // processed children and attributes of the open elements
+    std::vector<uint32_t> counters; // occurrences of the children of the open elements
+    const char* savedPos; // position after the last completely processed markup
+    const char* start; // input position of the document offset `startOffset`, behind the last text decoded in place
+    uint64_t startOffset;
+    Location startLocation; // of `start`
+    bool needMoreData; // the input ended within markup that may be completed by the next chunk
+    bool decodeInPlace; // the input is mutable and attribute values and text are decoded in it
+    xsd::error error;
+};
+
+// Character classes for the scanning primitives. Each class provides a scalar
+// test and SSE2/AVX2 variants that return a byte mask of the bytes to stop at.
+
+struct SpaceClass // stop at anything but white space
+{
+    bool stop(char c) const { return c != ' ' && (c < '\t' || c > '\r'); }
+#ifdef XSDCPP_SSE2
+    __m128i sse2(__m128i v) const
+    {
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))));
+        return _mm_xor_si128(space, _mm_set1_epi8(-1));
+    }
+#endif
+#ifdef XSDCPP_AVX2
+    XSDCPP_AVX2_TARGET __m256i avx2(__m256i v) const
+    {
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v)));
+        return _mm256_xor_si256(space, _mm256_set1_epi8(-1));
+    }
+#endif
+};
+
+template <char C>
+struct CharClass // stop at C (e.g. '<' for text or '-' for comments)
+{
+    bool stop(char c) const { return c == C; }
+#ifdef XSDCPP_SSE2
+    __m128i sse2(__m128i v) const { return _mm_cmpeq_epi8(v, _mm_set1_epi8(C)); }
+#endif
+#ifdef XSDCPP_AVX2
+    XSDCPP_AVX2_TARGET __m256i avx2(__m256i v) const { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(C)); }
+#endif
+};
+
+struct StringClass // stop at the closing quote or at a new line
+{
+    char quote;
+    explicit StringClass(char quote) : quote(quote) {}
+    bool stop(char c) const { return c == quote || c == '\n' || c == '\r'; }
+#ifdef XSDCPP_SSE2
+    __m128i sse2(__m128i v) const { return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(quote)), _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')))); }
+#endif
+#ifdef XSDCPP_AVX2
+    XSDCPP_AVX2_TARGET __m256i avx2(__m256i v) const { return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(quote)), _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')))); }
+#endif
+};
+
+struct TagClass // stop at the end of a tag or at the quote of an attribute value
+{
+    bool stop(char c) const { return c == '>' || c == '"' || c == '\''; }
+#ifdef XSDCPP_SSE2
+    __m128i sse2(__m128i v) const { return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('>')), _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\'')))); }
+#endif
+#ifdef XSDCPP_AVX2
+    XSDCPP_AVX2_TARGET __m256i avx2(__m256i v) const { return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('>')), _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')))); }
+#endif
+};
+
+struct NameClass // stop at the end of an attribute or tag name
+{
+    bool stop(char c) const { return !c || c == '/' || c == '>' || c == '=' || !SpaceClass().stop(c); }
+#ifdef XSDCPP_SSE2
+    __m128i sse2(__m128i v) const
+    {
+        __m128i delimiter = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), _mm_cmpeq_epi8(v, _mm_set1_epi8('/'))), _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('>')), _mm_cmpeq_epi8(v, _mm_set1_epi8('='))));
+        return _mm_or_si128(delimiter, _mm_xor_si128(SpaceClass().sse2(v), _mm_set1_epi8(-1)));
+    }
+#endif
+#ifdef XSDCPP_AVX2
+    XSDCPP_AVX2_TARGET __m256i avx2(__m256i v) const
+    {
+        __m256i delimiter = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'))), _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('>')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('='))));
+        return _mm256_or_si256(delimiter, _mm256_xor_si256(SpaceClass().avx2(v), _mm256_set1_epi8(-1)));
+    }
+#endif
 };
 
-void skipSpace(xsdcpp::Position& pos)
+#if defined(XSDCPP_SSE2) || defined(XSDCPP_AVX2)
+uint32_t countBits(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcount(v);
+#else
+    v = v - ((v >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+uint32_t findFirstBit(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(v);
+#else
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (uint32_t)index;
+#endif
+}
+
+uint32_t findLastBit(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - (uint32_t)__builtin_clz(v);
+#else
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return (uint32_t)index;
+#endif
+}
+
+// Accounts for a block of `width` bytes in which the bit masks `lf` and `cr` flag the new line characters.
+// A "\r\n" sequence counts as a single new line.
+void countLines(uint64_t& line, const char*& lineStart, const char* block, uint32_t width, uint32_t lf, uint32_t cr, const char* end)
+{
+    uint32_t crlf = cr & (lf >> 1);
+    if ((cr >> (width - 1)) & 1 && block + width < end && block[width] == '\n')
+        crlf |= 1u << (width - 1);
+    line += countBits(lf) + countBits(cr & ~crlf);
+    lineStart = block + findLastBit(lf | cr) + 1;
+}
+#endif
+
+template <typename Class>
+const char* scanScalar(const Class& charClass, const char* p, const char* end)
+{
+    for (; p < end; ++p)
+        if (charClass.stop(*p))
+            return p;
+    return end;
+}
+
+void locateScalar(const char* p, const char* end, uint64_t& line, const char*& lineStart)
 {
-    for (char c;;)
-        switch ((c = *pos.pos))
+    for (; p < end; ++p)
+    {
+        char c = *p;
+        if (c == '\r')
         {
-        case '\r':
-            if (*(++pos.pos) == '\n')
-                ++pos.pos;
-            ++pos.line;
-            pos.lineStart = pos.pos;
-            continue;
-        case '\n':
-            ++pos.line;
-            ++pos.pos;
-            pos.lineStart = pos.pos;
-            continue;
-        case '<':
-            if (strncmp(pos.pos + 1, "!--", 3) == 0)
-            {
-                pos.pos += 4;
-                for (;;)
-                {
-                    const char* end = strpbrk(pos.pos, "-\n\r");
-                    if (!end)
-                    {
-                        pos.pos = pos.pos + strlen(pos.pos);
-                        return;
-                    }
-                    pos.pos = end;
-                    switch (*pos.pos)
-                    {
-                    case '\r':
-                        if (*(++pos.pos) == '\n')
-                            ++pos.pos;
-                        ++pos.line;
-                        pos.lineStart = pos.pos;
-                        continue;
-                    case '\n':
-                        ++pos.line;
-                        ++pos.pos;
-                        pos.lineStart = pos.pos;
-                        continue;
-                    default:
-                        if (strncmp(pos.pos + 1, "->", 2) == 0)
-                        {
-                            pos.pos = end + 3;
-                            break;
-                        }
-                        ++pos.pos;
-                        continue;
-                    }
-                    break;
-                }
-                continue;
-            }
-            return;
-        case ' ':
-        case '\t':
-        case '\v':
-        case '\f':
-            ++pos.pos;
-            continue;
-        default:
-            return;
+            if (p + 1 < end && p[1] == '\n')
+                ++p;
+            ++line;
+            lineStart = p + 1;
+        }
+        else if (c == '\n')
+        {
+            ++line;
+            lineStart = p + 1;
         }
+    }
+}
+
+#ifdef XSDCPP_SSE2
+template <typename Class>
+const char* scanSse2(const Class& charClass, const char* p, const char* end)
+{
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        if (uint32_t stop = (uint32_t)_mm_movemask_epi8(charClass.sse2(v)))
+            return p + findFirstBit(stop);
+    }
+    return scanScalar(charClass, p, end);
+}
+
+void locateSse2(const char* p, const char* end, uint64_t& line, const char*& lineStart)
+{
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        uint32_t lf = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        uint32_t cr = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        if (lf | cr)
+            countLines(line, lineStart, p, 16, lf, cr, end);
+    }
+    locateScalar(p, end, line, lineStart);
+}
+#endif
+
+#ifdef XSDCPP_AVX2
+template <typename Class>
+XSDCPP_AVX2_TARGET const char* scanAvx2(const Class& charClass, const char* p, const char* end)
+{
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        if (uint32_t stop = (uint32_t)_mm256_movemask_epi8(charClass.avx2(v)))
+            return p + findFirstBit(stop);
+    }
+    return scanSse2(charClass, p, end);
+}
+
+XSDCPP_AVX2_TARGET void locateAvx2(const char* p, const char* end, uint64_t& line, const char*& lineStart)
+{
+    for (; end - p >= 32; p += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        uint32_t lf = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        uint32_t cr = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        if (lf | cr)
+            countLines(line, lineStart, p, 32, lf, cr, end);
+    }
+    locateSse2(p, end, line, lineStart);
+}
+#endif
+
+ScanLevel detectScanLevel()
+{
+#ifdef XSDCPP_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return avx2ScanLevel;
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7)
+    {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        __cpuidex(info, 7, 0);
+        if (osxsave && avx && (info[1] & (1 << 5)) && (_xgetbv(0) & 0x6) == 0x6)
+            return avx2ScanLevel;
+    }
+#endif
+#endif
+#ifdef XSDCPP_SSE2
+    return sse2ScanLevel;
+#else
+    return scalarScanLevel;
+#endif
+}
+
+ScanLevel getScanLevel()
+{
+    static const ScanLevel scanLevel = detectScanLevel();
+    return scanLevel;
+}
+
+// Returns the first character in [p, end) at which `charClass` stops or `end`.
+template <typename Class>
+const char* scan(const Context& context, const Class& charClass, const char* p)
+{
+    switch (context.scanLevel)
+    {
+#ifdef XSDCPP_AVX2
+    case avx2ScanLevel:
+        return scanAvx2(charClass, p, context.end);
+#endif
+#ifdef XSDCPP_SSE2
+    case sse2ScanLevel:
+        return scanSse2(charClass, p, context.end);
+#endif
+    default:
+        return scanScalar(charClass, p, context.end);
+    }
+}
+
+// Advances `location` from `p` to `end` by counting the new lines in between. New lines are not counted while
+// the input is scanned, since the location is only needed for error messages.
+void locate(const Context& context, const char* p, const char* end, Location& location)
+{
+    uint64_t line = location.line;
+    const char* lineStart = nullptr;
+    switch (context.scanLevel)
+    {
+#ifdef XSDCPP_AVX2
+    case avx2ScanLevel:
+        locateAvx2(p, end, line, lineStart);
+        break;
+#endif
+#ifdef XSDCPP_SSE2
+    case sse2ScanLevel:
+        locateSse2(p, end, line, lineStart);
+        break;
+#endif
+    default:
+        locateScalar(p, end, line, lineStart);
+        break;
+    }
+    location.line = line;
+    location.column = lineStart ? end - lineStart + 1 : location.column + (end - p);
+}
+
+// Records an error and returns false, so that it can be passed up with `return fail(...)`. `name` is the static name
+// of an element or attribute in the schema and `text` a name or value in the document that is copied to the error.
+bool fail(Context& context, const char* pos, xsd::error::code_t code, const char* name = nullptr, const char* text = nullptr, size_t textLength = 0, size_t limit = 0)
+{
+    xsd::error& error = context.error;
+    Location location = context.startLocation;
+    locate(context, context.start, pos, location);
+    error.code = code;
+    error.line = location.line;
+    error.column = location.column;
+    error.offset = context.startOffset + (pos - context.start);
+    error.name = name;
+    if (text)
+        error.text.assign(text, textLength);
+    else
+        error.text.clear();
+    error.limit = limit;
+    return false;
+}
+
+bool unexpectedEnd(Context& context)
+{
+    if (!context.final)
+        return (context.needMoreData = true), false;
+    return fail(context, context.pos, xsd::error::unexpected_end);
 }
 
-std::runtime_error SyntaxException(const xsdcpp::Position& pos, const std::string& error)
+bool startsWith(const Context& context, const char* p, const char* str, size_t length)
 {
-    std::stringstream s;
-    s << "Syntax error at line '" << pos.line << "': " << error;
-    return std::runtime_error(s.str());
+    return (size_t)(context.end - p) >= length && memcmp(p, str, length) == 0;
 }
 
-std::runtime_error VerificationException(const xsdcpp::Position& pos, const std::string& error)
+// Checks whether a comment starts at `p`. Fails if the input ends within what might be the start of a comment.
+bool isCommentStart(Context& context, const char* p, bool& comment)
 {
-    std::stringstream s;
-    s << "Error at line '" << pos.line << "': " << error;
-    return std::runtime_error(s.str());
+    size_t available = context.end - p;
+    if (available >= 4)
+        return (comment = memcmp(p, "<!--", 4) == 0), true;
+    if (!context.final && available && memcmp(p, "<!--", available) == 0)
+        return (context.needMoreData = true), false;
+    return (comment = false), true;
 }
 
-void skipText(xsdcpp::Position& pos)
+bool skipSpace(Context& context)
 {
+    const char*& pos = context.pos;
     for (;;)
     {
-        const char* end = strpbrk(pos.pos, "<\r\n");
-        if (!end)
-        {
-            pos.pos = pos.pos + strlen(pos.pos);
-            throw SyntaxException(pos, "Unexpected end of file");
-        }
-        pos.pos = end;
-        switch (*pos.pos)
+        pos = scan(context, SpaceClass(), pos);
+        bool comment;
+        if (!isCommentStart(context, pos, comment))
+            return false;
+        if (!comment)
+            return true;
+        for (pos += 4;;)
         {
-        case '\r':
-            if (*(++pos.pos) == '\n')
-                ++pos.pos;
-            ++pos.line;
-            pos.lineStart = pos.pos;
-            continue;
-        case '\n':
-            ++pos.line;
-            ++pos.pos;
-            pos.lineStart = pos.pos;
-            continue;
-        default:
-            if (pos.pos[1] == '!')
+            pos = scan(context, CharClass<'-'>(), pos);
+            if (pos == context.end)
+                return unexpectedEnd(context);
+            if (startsWith(context, pos, "-->", 3))
             {
-                skipSpace(pos);
-                continue;
+                pos += 3;
+                break;
             }
-            return;
+            ++pos;
         }
     }
 }
 
-const char* _escapeStrings[] = { "apos", "quot", "amp", "lt", "gt" };
-const char* _escapeChars = "'\"&<>";
+// Skips text in front of the next tag and sets `comments` if the text contained comments.
+bool skipText(Context& context, bool& comments)
+{
+    const char*& pos = context.pos;
+    comments = false;
+    for (;;)
+    {
+        pos = scan(context, CharClass<'<'>(), pos);
+        if (pos == context.end)
+            return unexpectedEnd(context);
+        bool comment;
+        if (!isCommentStart(context, pos, comment))
+            return false;
+        if (comment)
+        {
+            comments = true;
+            if (!skipSpace(context))
+                return false;
+            continue;
+        }
+        return true;
+    }
+}
 
-bool appendUnicode(uint32_t ch, std::string& str)
+// Writes the UTF-8 encoding of `ch` to `out` and returns its end or nullptr if `ch` is not a Unicode code point.
+char* encodeUnicode(uint32_t ch, char* out)
 {
     if ((ch & ~(0x80UL - 1)) == 0)
     {
-        str.push_back((char)ch);
-        return true;
+        *out++ = (char)ch;
+        return out;
     }
     if ((ch & ~(0x800UL - 1)) == 0)
     {
-        str.push_back((ch >> 6) | 0xC0);
-        str.push_back((ch & 0x3F) | 0x80);
-        return true;
+        *out++ = (char)((ch >> 6) | 0xC0);
+        *out++ = (char)((ch & 0x3F) | 0x80);
+        return out;
     }
     if ((ch & ~(0x10000UL - 1)) == 0)
     {
-        str.push_back((ch >> 12) | 0xE0);
-        str.push_back(((ch >> 6) & 0x3F) | 0x80);
-        str.push_back((ch & 0x3F) | 0x80);
-        return true;
+        *out++ = (char)((ch >> 12) | 0xE0);
+        *out++ = (char)(((ch >> 6) & 0x3F) | 0x80);
+        *out++ = (char)((ch & 0x3F) | 0x80);
+        return out;
     }
     if (ch < 0x110000UL)
     {
-        str.push_back((ch >> 18) | 0xF0);
-        str.push_back(((ch >> 12) & 0x3F) | 0x80);
-        str.push_back(((ch >> 6) & 0x3F) | 0x80);
-        str.push_back((ch & 0x3F) | 0x80);
-        return true;
+        *out++ = (char)((ch >> 18) | 0xF0);
+        *out++ = (char)(((ch >> 12) & 0x3F) | 0x80);
+        *out++ = (char)(((ch >> 6) & 0x3F) | 0x80);
+        *out++ = (char)((ch & 0x3F) | 0x80);
+        return out;
     }
-    return false;
+    return nullptr;
 }
 
-std::string unescapeString(const char* str, size_t len)
+// Returns the character of one of the predefined entities or 0.
+char findEntity(const char* name, size_t length)
 {
-    std::string result;
-    result.reserve(len);
+    switch (length)
+    {
+    case 2:
+        if (name[1] == 't')
+            return name[0] == 'l' ? '<' : name[0] == 'g' ? '>' : 0;
+        return 0;
+    case 3:
+        return memcmp(name, "amp", 3) == 0 ? '&' : 0;
+    case 4:
+        return memcmp(name, "apos", 4) == 0 ? '\'' : memcmp(name, "quot", 4) == 0 ? '"' : 0;
+    default:
+        return 0;
+    }
+}
+
+char* copyText(const char* str, size_t len, char* out)
+{
+    if (out != str)
+        memmove(out, str, len);
+    return out + len;
+}
+
+// Reads the code point of a numeric character reference from the characters between "&#" and ";", which are decimal
+// digits or an "x" followed by hexadecimal digits. Fails for code points that are not characters (0, surrogates and
+// values beyond U+10FFFF).
+bool readCodePoint(const char* str, const char* end, uint32_t& result)
+{
+    uint32_t value = 0;
+    bool hex = str != end && *str == 'x';
+    if (hex)
+        ++str;
+    if (str == end)
+        return false;
+    for (; str != end; ++str)
+    {
+        uint32_t digit = (unsigned char)*str - (unsigned char)'0';
+        if (digit <= 9)
+            value = value * (hex ? 16 : 10) + digit;
+        else if (hex && (digit = ((unsigned char)*str | 0x20) - (unsigned char)'a') < 6)
+            value = value * 16 + digit + 10;
+        else
+            return false;
+        if (value > 0x10FFFF)
+            return false;
+    }
+    if (!value || (value >= 0xD800 && value <= 0xDFFF))
+        return false;
+    result = value;
+    return true;
+}
+
+// Writes the text with its entity references decoded to `out` and returns the end of the decoded text. The decoded
+// text is never longer than the input, so `out` may point to the input to decode it in place. Runs of text without
+// entity references are skipped with memchr, which is vectorized in common C runtime libraries. The ';' of a
+// reference is only searched for within the length of the longest reference ("&#x10FFFF;"), so that text with many
+// bare '&' characters is not scanned to its end for each of them.
+char* decodeEntities(const char* str, size_t len, char* out)
+{
+    const size_t maxReferenceLength = 10;
     for (const char* i = str, * end = str + len;;)
     {
-        size_t remainingLen = end - i;
-        const char* next = (const char*)memchr(i, '&', remainingLen);
+        const char* next = (const char*)memchr(i, '&', end - i);
         if (!next)
-            return result.append(i, remainingLen);
-        else
-            result.append(i, next - i);
+            return copyText(i, end - i, out);
+        out = copyText(i, next - i, out);
         i = next + 1;
-        remainingLen = end - i;
-        const char* sequenceEnd = (const char*)memchr(i, ';', remainingLen);
-        if (!sequenceEnd)
+        const char* sequenceEnd = (const char*)memchr(i, ';', std::min((size_t)(end - i), maxReferenceLength - 1));
+        if (sequenceEnd)
         {
-            result.push_back('&');
-            continue;
-        }
-        if (*i == '#')
-        {
-            char* endptr;
-            uint32_t unicodeValue = i[1] == 'x' ? strtoul(i + 2, &endptr, 16) : strtoul(i + 1, &endptr, 10);
-            if (endptr != sequenceEnd || !appendUnicode(unicodeValue, result))
+            if (*i == '#')
             {
-                result.push_back('&');
-                continue;
+                uint32_t codePoint;
+                if (readCodePoint(i + 1, sequenceEnd, codePoint))
+                {
+                    out = encodeUnicode(codePoint, out);
+                    i = sequenceEnd + 1;
+                    continue;
+                }
             }
-            i = sequenceEnd + 1;
-            continue;
-        }
-        size_t sequenceLen = sequenceEnd - i;
-        for (const char **j = _escapeStrings, **end = _escapeStrings + sizeof(_escapeStrings) / sizeof(*_escapeStrings); j < end; ++j)
-            if (strncmp(i, *j, sequenceLen) == 0)
+            else if (char c = findEntity(i, sequenceEnd - i))
             {
-                result.push_back(_escapeChars[j - _escapeStrings]);
+                *out++ = c;
                 i = sequenceEnd + 1;
-                goto sequenceTranslated;
+                continue;
             }
-        result.push_back('&');
-    sequenceTranslated:;
+        }
+        *out++ = '&';
     }
 }
 
-std::string stripComments(const char* str, size_t len)
+void unescapeString(const char* str, size_t len, std::string& result)
+{
+    size_t size = result.size();
+    result.resize(size + len);
+    result.resize(decodeEntities(str, len, &result[size]) - result.data());
+}
+
+std::string unescapeString(const char* str, size_t len)
 {
     std::string result;
-    result.reserve(len);
+    unescapeString(str, len, result);
+    return result;
+}
+
+char* appendText(const char* str, size_t len, bool unescape, char* out)
+{
+    return unescape ? decodeEntities(str, len, out) : copyText(str, len, out);
+}
+
+// Writes text without the comments in it to `out` and returns the end of the written text. The entity references in
+// the text are decoded if `unescape` is set. Like with decodeEntities, `out` may point to the input.
+char* stripComments(const char* str, size_t len, bool unescape, char* out)
+{
     for (const char* i = str, * end = str + len;;)
     {
         size_t remainingLen = end - i;
         const char* next = (const char*)memchr(i, '<', remainingLen);
         if (!next)
-            return result.append(i, remainingLen);
+            return appendText(i, remainingLen, unescape, out);
         else
-            result.append(i, next - i);
+            out = appendText(i, next - i, unescape, out);
         i = next;
-        if (strncmp(i + 1, "!--", 3) != 0)
-            return result.append(i, end - i);
+        if (end - i < 4 || memcmp(i + 1, "!--", 3) != 0)
+            return appendText(i, end - i, unescape, out);
         i += 4;
         for (;;)
         {
-            const char* commentEnd = strpbrk(i, "-");
+            const char* commentEnd = (const char*)memchr(i, '-', end - i);
             if (!commentEnd)
-            {
-                i = end;
-                continue;
-            }
+                return out;
             i = commentEnd;
-            if (strncmp(i + 1, "->", 2) == 0)
+            if (end - i >= 3 && memcmp(i + 1, "->", 2) == 0)
             {
                 i += 3;
                 break;
@@ -281,373 +680,1411 @@ std::string stripComments(const char* str, size_t len)
     }
 }
 
-void readToken(Context& context)
+// Appends text without the comments in it to `result`. The entity references in the text are decoded if `unescape` is set.
+void stripComments(const char* str, size_t len, bool unescape, std::string& result)
+{
+    size_t size = result.size();
+    result.resize(size + len);
+    result.resize(stripComments(str, len, unescape, &result[size]) - result.data());
+}
+
+bool readToken(Context& context)
 {
-    skipSpace(context.pos);
+    if (!skipSpace(context))
+        return false;
     context.token.pos = context.pos;
-    switch (*context.pos.pos)
+    if (context.pos == context.end)
+        return unexpectedEnd(context);
+    switch (*context.pos)
     {
     case '<':
-        if (context.pos.pos[1] == '/')
+        if (context.end - context.pos > 1 && context.pos[1] == '/')
         {
             context.token.type = Token::endTagBeginType;
-            context.pos.pos += 2;
-            return;
+            context.pos += 2;
+            return true;
         }
         context.token.type = Token::startTagBeginType;
-        ++context.pos.pos;
-        return;
+        ++context.pos;
+        return true;
     case '>':
         context.token.type = Token::tagEndType;
-        ++context.pos.pos;
-        return;
+        ++context.pos;
+        return true;
     case '\0':
-        throw SyntaxException(context.pos, "Unexpected end of file");
+        return fail(context, context.pos, xsd::error::unexpected_end);
     case '=':
         context.token.type = Token::equalsSignType;
-        ++context.pos.pos;
-        return;
+        ++context.pos;
+        return true;
     case '"':
     case '\'': {
-        char endChars[4] = "x\r\n";
-        *endChars = *context.pos.pos;
-        const char* end = strpbrk(context.pos.pos + 1, endChars);
-        if (!end)
-            throw SyntaxException(context.pos, "Unexpected end of file");
-        if (*end != *context.pos.pos)
-            throw SyntaxException(context.pos, "New line in string");
-        context.token.value = unescapeString(context.pos.pos + 1, end - context.pos.pos - 1);
+        const char* end = scan(context, StringClass(*context.pos), context.pos + 1);
+        if (end == context.end)
+            return unexpectedEnd(context);
+        if (*end != *context.pos)
+            return fail(context, context.pos, xsd::error::new_line_in_string);
+        context.token.value = context.pos + 1;
+        context.token.length = end - context.pos - 1;
         context.token.type = Token::stringType;
-        context.pos.pos = end + 1;
-        return;
+        context.pos = end + 1;
+        return true;
     }
     case '/':
-        if (context.pos.pos[1] == '>')
+        if (context.end - context.pos > 1 && context.pos[1] == '>')
         {
             context.token.type = Token::emptyTagEndType;
-            context.pos.pos += 2;
-            return;
+            context.pos += 2;
+            return true;
         }
         // no break
     default: // attribute or tag name
         {
-            const char* end = context.pos.pos;
-            while (*end && *end != '/' && *end != '>' && *end != '=' && !isspace(*end))
-                ++end;
-            if (end == context.pos.pos)
-                throw SyntaxException(context.pos, "Expected name");
-            context.token.value = std::string(context.pos.pos, end - context.pos.pos);
+            const char* end = scan(context, NameClass(), context.pos);
+            if (end == context.pos)
+                return fail(context, context.pos, xsd::error::expected_name);
+            context.token.value = context.pos;
+            context.token.length = end - context.pos;
             context.token.type = Token::nameType;
-            context.pos.pos = end;
-            return;
+            context.pos = end;
+            return true;
         }
     }
 }
 
-void skipTextAndSubElements(Context& context, const std::string& elementName)
+bool equals(const char* str, const char* name, size_t length)
+{
+    return strncmp(str, name, length) == 0 && str[length] == '\0';
+}
+
+bool isNamespaceQualified(const char* name, size_t length, const char*& localName, size_t& localNameLength)
+{
+    const char* n = (const char*)memchr(name, ':', length);
+    if (!n)
+        return false;
+    localName = n + 1;
+    localNameLength = length - (localName - name);
+    return true;
+}
+
+// Skips the markup up to the next occurrence of `str` and the string itself.
+bool skipPast(Context& context, const char* str, size_t length)
 {
+    const char*& pos = context.pos;
     for (;;)
     {
-        skipText(context.pos);
-        xsdcpp::Position posBackup = context.pos;
-        readToken(context);
-        switch (context.token.type)
+        switch (*str)
         {
-        case Token::startTagBeginType:
-            readToken(context);
-            if (context.token.type == Token::nameType)
-            {
-                std::string elementName = std::move(context.token.value);
-                skipTextAndSubElements(context, elementName);
-                readToken(context);
-            }
+        case '>':
+            pos = scan(context, CharClass<'>'>(), pos);
             break;
-        case Token::endTagBeginType:
-            readToken(context);
-            if (context.token.type == Token::nameType && context.token.value == elementName)
-            {
-                context.pos = posBackup;
-                return;
-            }
+        case '?':
+            pos = scan(context, CharClass<'?'>(), pos);
             break;
         default:
+            pos = scan(context, CharClass<']'>(), pos);
             break;
         }
+        if (pos == context.end)
+            return unexpectedEnd(context);
+        if (startsWith(context, pos, str, length))
+        {
+            pos += length;
+            return true;
+        }
+        if ((size_t)(context.end - pos) < length)
+            return unexpectedEnd(context);
+        ++pos;
     }
 }
 
-xsdcpp::ElementContext enterElement(Context& context, xsdcpp::ElementContext& parentElementContext, const xsdcpp::ChildElementInfo& childInfo)
+// Skips the text and the sub elements of an element up to (but not including) its end tag and sets `comments`
+// if comments were skipped. Sub elements are not parsed, they are only counted to find the matching end tag.
+bool skipTextAndSubElements(Context& context, const char* elementName, size_t elementNameLength, bool& comments)
 {
-    size_t& count = parentElementContext.processedElements2[childInfo.trackIndex];
-    if (childInfo.maxOccurs && count >= childInfo.maxOccurs)
+    const char*& pos = context.pos;
+    comments = false;
+    for (size_t depth = 0;;)
     {
-        std::stringstream s;
-        s << "Maximum occurrence of element '" << childInfo.name << "' is " << childInfo.maxOccurs ;
-        throw VerificationException(context.pos,  s.str());
+        bool textComments;
+        if (!skipText(context, textComments))
+            return false;
+        if (textComments)
+            comments = true;
+        const char* p = pos;
+        if ((size_t)(context.end - p) < 2)
+            return unexpectedEnd(context);
+        switch (p[1])
+        {
+        case '/':
+            if (depth)
+            {
+                --depth;
+                pos += 2;
+                if (!skipPast(context, ">", 1))
+                    return false;
+                continue;
+            }
+            if ((size_t)(context.end - p) <= 2 + elementNameLength)
+                return unexpectedEnd(context);
+            if (memcmp(p + 2, elementName, elementNameLength) != 0 || !NameClass().stop(p[2 + elementNameLength]))
+                return fail(context, pos, xsd::error::expected_end_tag, nullptr, elementName, elementNameLength);
+            return true;
+        case '?':
+            pos += 2;
+            if (!skipPast(context, "?>", 2))
+                return false;
+            continue;
+        case '!':
+            pos += 2;
+            if (!(startsWith(context, pos, "[CDATA[", 7) ? skipPast(context, "]]>", 3) : skipPast(context, ">", 1)))
+                return false;
+            continue;
+        default:
+            for (++pos;;)
+            {
+                pos = scan(context, TagClass(), pos);
+                if (pos == context.end)
+                    return unexpectedEnd(context);
+                char c = *pos++;
+                if (c == '>')
+                {
+                    if (pos[-2] != '/')
+                        ++depth;
+                    break;
+                }
+                if (c == '"')
+                    pos = scan(context, CharClass<'"'>(), pos);
+                else
+                    pos = scan(context, CharClass<'\''>(), pos);
+                if (pos == context.end)
+                    return unexpectedEnd(context);
+                ++pos;
+            }
+            continue;
+        }
     }
-    ++count;
-    return xsdcpp::ElementContext(childInfo.info, childInfo.getElementField(parentElementContext.element));
 }
 
-xsdcpp::ElementContext enterElement(Context& context, xsdcpp::ElementContext& parentElementContext, const std::string& name)
+bool isXmlSpace(char c)
 {
-    for (const xsdcpp::ElementInfo* i = parentElementContext.info; i; i = i->base)
-        if (const xsdcpp::ChildElementInfo* c = i->children)
-            for (; c->name; ++c)
-                if (name == c->name)
-                    return enterElement(context, parentElementContext, *c);
-    size_t n = name.find(':');
-    if (n != std::string::npos)
-    {
-        std::string nameWithoutNamespace = name.substr(n + 1);
-        for (const xsdcpp::ElementInfo* i = parentElementContext.info; i; i = i->base)
-            if (const xsdcpp::ChildElementInfo* c = i->children)
-                for (; c->name; ++c)
-                    if (nameWithoutNamespace == c->name)
-                        return enterElement(context, parentElementContext, *c);
-    }
-    throw VerificationException(context.pos, "Unexpected element '" + name + "'");
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-void checkElement(Context& context, const xsdcpp::ElementContext& elementContext)
+void trimSpace(const char*& data, const char*& end)
 {
-    if (elementContext.info->flags & xsdcpp::ElementInfo::CheckChildrenFlag)
-        for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
-            if (const xsdcpp::ChildElementInfo* c = i->children)
-                for (; c->name; ++c)
-                    if (elementContext.processedElements2[c->trackIndex] < c->minOccurs)
-                    {
-                        std::stringstream s;
-                        s << "Minimum occurrence of element '" << c->name << "' is " << c->minOccurs;
-                        throw VerificationException(context.pos, s.str());
-                    }
+    while (data != end && isXmlSpace(*data))
+        ++data;
+    while (end != data && isXmlSpace(end[-1]))
+        --end;
 }
 
-void setAttribute(Context& context, xsdcpp::ElementContext& elementContext, std::string&& name, std::string&& value)
+bool parseDigits(const char* data, const char* end, uint64_t max, uint64_t& result)
 {
-    for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
-        if (const xsdcpp::AttributeInfo* a = i->attributes)
-            for (; a->name; ++a)
-                if (name == a->name)
-                {
-                    if (elementContext.processedAttributes2 & a->trackBit)
-                        throw VerificationException(context.pos, "Repeated attribute '" + name + "'");
-                    elementContext.processedAttributes2 |= a->trackBit;
-                    a->setValue(a->getAttribute(elementContext.element), context.pos, std::move(value));
-                    return;
-                }
-    if (elementContext.info->flags & xsdcpp::ElementInfo::EntryPointFlag)
+    if (data == end)
+        return false;
+    uint64_t value = 0;
+    for (; data != end; ++data)
     {
-        if (name.compare(0, 5, "xmlns") == 0 && (name.size() == 5 || name.c_str()[5] == ':'))
-        {
-            std::string namespacePrefix;
-            if (name.size() > 6)
-                namespacePrefix = name.substr(6);
-            size_t namespaceIndex = 0;
-            for (const char** ns = context.namespaces; *ns; ++ns, ++namespaceIndex)
-                if (value == *ns)
-                    return;
-            throw VerificationException(context.pos, "Unknown namespace '" + value + "'");
-        }
-        size_t n = name.find(':');
-        if (n != std::string::npos)
-        {
-            ++n;
-             if (name.compare(n, std::string::npos, "noNamespaceSchemaLocation") == 0 ||
-                 name.compare(n, std::string::npos, "schemaLocation") == 0)
-                 return;
-        }
+        uint64_t digit = (unsigned char)*data - (unsigned char)'0';
+        if (digit > 9 || value > (max - digit) / 10)
+            return false;
+        value = value * 10 + digit;
     }
-    for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
-        if (i->flags & xsdcpp::ElementInfo::AnyAttributeFlag)
-        {
-            i->setOtherAttribute(elementContext.element, std::move(name), std::move(value));
-            return;
-        }
-
-    throw VerificationException(context.pos, "Unexpected attribute '" + name + "'");
+    result = value;
+    return true;
 }
 
-void checkAttributes(Context& context, xsdcpp::ElementContext& elementContext)
+template <typename T>
+bool toUnsigned(const char* data, size_t length, T& result)
 {
-    uint64_t missingAttributes = elementContext.info->checkAttributeMask & ~elementContext.processedAttributes2;
-    if (missingAttributes)
-    {
-        for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
-            if (const xsdcpp::AttributeInfo* a = i->attributes)
-                for (; a->name; ++a)
-                    if (missingAttributes & a->trackBit)
-                    {
-                        if (a->isMandatory)
-                            throw VerificationException(context.pos, "Missing attribute '" + std::string(a->name) + "'");
-                        a->setDefaultValue(elementContext.element);
-                    }
+    const char* end = data + length;
+    trimSpace(data, end);
+    if (data != end && *data == '+')
+        ++data;
+    uint64_t value;
+    if (!parseDigits(data, end, std::numeric_limits<T>::max(), value))
+        return false;
+    result = (T)value;
+    return true;
+}
+
+template <typename T>
+bool toSigned(const char* data, size_t length, T& result)
+{
+    const char* end = data + length;
+    trimSpace(data, end);
+    bool negative = data != end && *data == '-';
+    if (data != end && (*data == '-' || *data == '+'))
+        ++data;
+    uint64_t max = (uint64_t)std::numeric_limits<T>::max();
+    uint64_t value;
+    if (!parseDigits(data, end, negative ? max + 1 : max, value))
+        return false;
+    result = negative && value ? (T)(-(int64_t)(value - 1) - 1) : (T)value;
+    return true;
+}
+
+bool toBool(const char* data, size_t length, bool& result)
+{
+    const char* end = data + length;
+    trimSpace(data, end);
+    length = end - data;
+    if ((length == 4 && memcmp(data, "true", 4) == 0) || (length == 1 && *data == '1'))
+        return (result = true), true;
+    if ((length == 5 && memcmp(data, "false", 5) == 0) || (length == 1 && *data == '0'))
+        return (result = false), true;
+    return false;
+}
+
+// The "C" locale, which is created once, so that numbers can be converted independently of the locale of the process.
+class CLocale
+{
+public:
+#ifdef _WIN32
+    typedef _locale_t Handle;
+#else
+    typedef locale_t Handle;
+#endif
+
+    static Handle get()
+    {
+        static const CLocale cLocale;
+        return cLocale._handle;
+    }
+
+private:
+    Handle _handle;
+
+#ifdef _WIN32
+    CLocale() : _handle(_create_locale(LC_NUMERIC, "C")) {}
+    ~CLocale() { _free_locale(_handle); }
+#else
+    CLocale() : _handle(newlocale(LC_NUMERIC_MASK, "C", (locale_t)0)) {}
+    ~CLocale() { freelocale(_handle); }
+#endif
+};
+
+template <typename T>
+struct FloatTraits;
+
+template <>
+struct FloatTraits<double>
+{
+    static const int maxExactPowerOfTen = 22;
+#ifdef _WIN32
+    static double parse(const char* str, char** endptr) { return _strtod_l(str, endptr, CLocale::get()); }
+#else
+    static double parse(const char* str, char** endptr) { return strtod_l(str, endptr, CLocale::get()); }
+#endif
+};
+
+template <>
+struct FloatTraits<float>
+{
+    static const int maxExactPowerOfTen = 10;
+#ifdef _WIN32
+    static float parse(const char* str, char** endptr) { return _strtof_l(str, endptr, CLocale::get()); }
+#else
+    static float parse(const char* str, char** endptr) { return strtof_l(str, endptr, CLocale::get()); }
+#endif
+};
+
+const double _powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Reads a decimal floating point number of the XSD lexical space ([+-]digits[.digits][(e|E)[+-]digits], INF, -INF or NaN).
+// If the decimal significand and the power of ten are both exactly representable, a single multiplication or division
+// gives the correctly rounded result. Other numbers are converted with strtod/strtof (in the "C" locale) after the number
+// has been validated.
+template <typename T>
+bool toFloat(const char* data, size_t length, T& result)
+{
+    const char* end = data + length;
+    trimSpace(data, end);
+    const char* start = data;
+    bool negative = false;
+    if (data != end && (*data == '-' || *data == '+'))
+        negative = *data++ == '-';
+    if (end - data == 3)
+    {
+        if (memcmp(data, "INF", 3) == 0)
+            return (result = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity()), true;
+        if (memcmp(data, "NaN", 3) == 0 && data == start)
+            return (result = std::numeric_limits<T>::quiet_NaN()), true;
+    }
+
+    uint64_t significand = 0;
+    int significandDigits = 0;
+    int exponent = 0;
+    bool inexact = false;
+    bool hasDigits = false;
+    bool fraction = false;
+    for (; data != end; ++data)
+    {
+        unsigned digit = (unsigned char)*data - (unsigned char)'0';
+        if (digit > 9)
+        {
+            if (*data == '.' && !fraction)
+            {
+                fraction = true;
+                continue;
+            }
+            break;
+        }
+        hasDigits = true;
+        if (significandDigits < 19)
+        {
+            if (significand || digit)
+            {
+                significand = significand * 10 + digit;
+                ++significandDigits;
+            }
+            if (fraction)
+                --exponent;
+        }
+        else
+        {
+            if (!fraction)
+                ++exponent;
+            if (digit)
+                inexact = true;
+        }
+    }
+    if (!hasDigits)
+        return false;
+    if (data != end && (*data == 'e' || *data == 'E'))
+    {
+        ++data;
+        bool negativeExponent = false;
+        if (data != end && (*data == '-' || *data == '+'))
+            negativeExponent = *data++ == '-';
+        if (data == end)
+            return false;
+        int explicitExponent = 0;
+        for (; data != end; ++data)
+        {
+            unsigned digit = (unsigned char)*data - (unsigned char)'0';
+            if (digit > 9)
+                return false;
+            if (explicitExponent < 100000)
+                explicitExponent = explicitExponent * 10 + digit;
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (data != end)
+        return false;
+
+    if (!significand)
+        return (result = negative ? -(T)0 : (T)0), true;
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    if (!inexact && significand <= (uint64_t)1 << std::numeric_limits<T>::digits &&
+        exponent >= -FloatTraits<T>::maxExactPowerOfTen && exponent <= FloatTraits<T>::maxExactPowerOfTen)
+    {
+        T value = (T)significand;
+        if (exponent < 0)
+            value /= (T)_powersOfTen[-exponent];
+        else
+            value *= (T)_powersOfTen[exponent];
+        result = negative ? -value : value;
+        return true;
+    }
+#endif
+
+    // strtod expects a null-terminated string
+    length = end - start;
+    char buffer[64];
+    std::string longBuffer;
+    char* str = buffer;
+    if (length >= sizeof(buffer))
+    {
+        longBuffer.resize(length + 1);
+        str = &longBuffer[0];
+    }
+    memcpy(str, start, length);
+    str[length] = '\0';
+    char* endptr;
+    result = FloatTraits<T>::parse(str, &endptr);
+    return endptr == str + length;
+}
+
+const xsdcpp::ChildElementInfo* findChildElement(const xsdcpp::ElementInfo* info, const char* name, size_t length)
+{
+    const xsdcpp::ChildElementInfo* childInfo = nullptr;
+    if (xsdcpp::find_child_t findChild = info->findChild)
+    {
+        childInfo = findChild(name, length);
+        const char* localName;
+        size_t localNameLength;
+        if (!childInfo && isNamespaceQualified(name, length, localName, localNameLength))
+            childInfo = findChild(localName, localNameLength);
+    }
+    return childInfo;
+}
+
+size_t getTrackWords(const xsdcpp::ElementInfo* info)
+{
+    return (info->trackCount + 63) / 64;
+}
+
+bool isTracked(const uint64_t* trackBits, size_t index)
+{
+    return (trackBits[index / 64] >> (index % 64)) & 1;
+}
+
+void pushFrame(Context& context, const xsdcpp::ElementInfo* info, void* element, const xsdcpp::ChildElementInfo* childInfo, size_t nameOffset, size_t nameLength)
+{
+    size_t trackOffset = context.trackBits.size();
+    size_t counterOffset = context.counters.size();
+    context.trackBits.resize(trackOffset + getTrackWords(info));
+    context.counters.resize(counterOffset + info->counterCount);
+    context.stack.emplace_back(info, element, childInfo, nameOffset, nameLength, trackOffset, counterOffset);
+}
+
+bool enterElement(Context& context, const char* name, size_t length)
+{
+    const Frame& parentFrame = context.stack.back();
+    const xsdcpp::ElementContext& parentElementContext = parentFrame.elementContext;
+    const xsdcpp::ChildElementInfo* childInfo = findChildElement(parentElementContext.info, name, length);
+    if (!childInfo)
+        return fail(context, context.pos, xsd::error::unexpected_element, nullptr, name, length);
+
+    uint64_t& trackWord = context.trackBits[parentFrame.trackOffset + childInfo->trackIndex / 64];
+    uint64_t trackBit = (uint64_t)1 << (childInfo->trackIndex % 64);
+    if (childInfo->counterIndex != xsdcpp::ChildElementInfo::noCounter)
+    {
+        uint32_t& count = context.counters[parentFrame.counterOffset + childInfo->counterIndex];
+        if (childInfo->maxOccurs && count >= childInfo->maxOccurs)
+            return fail(context, context.pos, xsd::error::max_occurs, childInfo->name, nullptr, 0, childInfo->maxOccurs);
+        if (count != UINT32_MAX)
+            ++count;
+    }
+    else if (childInfo->maxOccurs && (trackWord & trackBit))
+        return fail(context, context.pos, xsd::error::max_occurs, childInfo->name, nullptr, 0, 1);
+    trackWord |= trackBit;
+    if (context.maxDepth && context.stack.size() > context.maxDepth)
+        return fail(context, context.pos, xsd::error::max_depth, nullptr, nullptr, 0, context.maxDepth);
+    void* element = childInfo->getElementField(parentElementContext.element);
+    size_t nameOffset = context.names.size();
+    context.names.append(name, length);
+    pushFrame(context, childInfo->info, element, childInfo, nameOffset, length);
+    return true;
+}
+
+void startElement(Context& context)
+{
+    const Frame& frame = context.stack.back();
+    if (context.handler)
+        context.handler->startElement(*frame.childInfo, frame.elementContext.element);
+}
+
+void leaveElement(Context& context)
+{
+    const Frame& frame = context.stack.back();
+    Frame& parentFrame = context.stack[context.stack.size() - 2];
+    if (context.handler && context.handler->endElement(*frame.childInfo, frame.elementContext.element))
+        if (xsdcpp::remove_field_t removeElementField = frame.childInfo->removeElementField)
+            removeElementField(parentFrame.elementContext.element);
+    context.names.resize(frame.nameOffset);
+    context.trackBits.resize(frame.trackOffset);
+    context.counters.resize(frame.counterOffset);
+    context.stack.pop_back();
+    parentFrame.textRead = false;
+}
+
+bool checkElement(Context& context, const Frame& frame)
+{
+    const xsdcpp::ElementInfo* info = frame.elementContext.info;
+    const uint64_t* trackBits = context.trackBits.data() + frame.trackOffset;
+    bool missing = false;
+    if (const uint64_t* requiredChildren = info->requiredChildren)
+        for (size_t i = 0, count = getTrackWords(info); i < count; ++i)
+            if (requiredChildren[i] & ~trackBits[i])
+            {
+                missing = true;
+                break;
+            }
+    if (!missing && !(info->flags & xsdcpp::ElementInfo::CheckMinOccursFlag))
+        return true;
+    const uint32_t* counters = context.counters.data() + frame.counterOffset;
+    for (const xsdcpp::ElementInfo* i = info; i; i = i->base)
+        if (const xsdcpp::ChildElementInfo* c = i->children)
+            for (; c->name; ++c)
+                if (c->minOccurs && (c->counterIndex == xsdcpp::ChildElementInfo::noCounter ? !isTracked(trackBits, c->trackIndex) : counters[c->counterIndex] < c->minOccurs))
+                    return fail(context, context.pos, xsd::error::min_occurs, c->name, nullptr, 0, c->minOccurs);
+    return true;
+}
+
+// Removes the comments from (if `comments` is set) and decodes the entity references in (if `unescape` is set) text
+// in the input buffer and returns its new length. The bytes that are freed at the end are overwritten with spaces.
+// If new lines may be removed with comments or added with character references, the location of the end of the text
+// is computed before decoding and errors reported later are located from there, so that their lines and columns are
+// the same as without decoding in place.
+size_t decodeInPlace(Context& context, const char* str, size_t len, bool comments, bool unescape)
+{
+    char* data = (char*)str;
+    if (comments || memchr(str, '#', len))
+    {
+        locate(context, context.start, str + len, context.startLocation);
+        context.startOffset += str + len - context.start;
+        context.start = str + len;
+    }
+    char* end = comments ? stripComments(str, len, unescape, data) : decodeEntities(str, len, data);
+    memset(end, ' ', data + len - end);
+    return end - data;
+}
+
+bool setAttribute(Context& context, const Frame& frame, const char* name, size_t nameLength, const char* value, size_t valueLength)
+{
+    const xsdcpp::ElementContext& elementContext = frame.elementContext;
+    const xsdcpp::AttributeInfo* attribute = elementContext.info->findAttribute ? elementContext.info->findAttribute(name, nameLength) : nullptr;
+    if (attribute == &xsdcpp::namespaceAttribute)
+    {
+        std::string namespace_ = unescapeString(value, valueLength);
+        for (const char** ns = context.namespaces; *ns; ++ns)
+            if (namespace_ == *ns)
+                return true;
+        return fail(context, context.pos, xsd::error::unknown_namespace, nullptr, namespace_.data(), namespace_.size());
+    }
+    if (attribute == &xsdcpp::schemaLocationAttribute)
+        return true;
+    if (attribute)
+    {
+        uint64_t& trackWord = context.trackBits[frame.trackOffset + attribute->trackIndex / 64];
+        uint64_t trackBit = (uint64_t)1 << (attribute->trackIndex % 64);
+        if (trackWord & trackBit)
+            return fail(context, context.pos, xsd::error::repeated_attribute, attribute->name);
+        trackWord |= trackBit;
+        if (memchr(value, '&', valueLength))
+        {
+            if (context.decodeInPlace)
+                valueLength = decodeInPlace(context, value, valueLength, false, true);
+            else
+            {
+                context.buffer.clear();
+                unescapeString(value, valueLength, context.buffer);
+                value = context.buffer.data();
+                valueLength = context.buffer.size();
+            }
+        }
+        if (xsd::error::code_t code = attribute->setValue(attribute->getAttribute(elementContext.element), value, valueLength))
+            return fail(context, context.pos, code, attribute->name, value, valueLength);
+        return true;
     }
+    for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
+        if (i->flags & xsdcpp::ElementInfo::AnyAttributeFlag)
+        {
+            i->setOtherAttribute(elementContext.element, std::string(name, nameLength), unescapeString(value, valueLength));
+            return true;
+        }
+
+    return fail(context, context.pos, xsd::error::unexpected_attribute, nullptr, name, nameLength);
 }
 
-void parseElement(Context& context, xsdcpp::ElementContext& parentElementContext)
+bool checkAttributes(Context& context, const Frame& frame)
 {
-    readToken(context);
+    const xsdcpp::ElementContext& elementContext = frame.elementContext;
+    const uint64_t* checkAttributes = elementContext.info->checkAttributes;
+    if (!checkAttributes)
+        return true;
+    const uint64_t* trackBits = context.trackBits.data() + frame.trackOffset;
+    for (size_t i = 0, count = getTrackWords(elementContext.info); i < count; ++i)
+        if (checkAttributes[i] & ~trackBits[i])
+        {
+            for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
+                if (const xsdcpp::AttributeInfo* a = i->attributes)
+                    for (; a->name; ++a)
+                        if (isTracked(checkAttributes, a->trackIndex) && !isTracked(trackBits, a->trackIndex))
+                        {
+                            if (a->isMandatory)
+                                return fail(context, context.pos, xsd::error::missing_attribute, a->name);
+                            a->setDefaultValue(elementContext.element);
+                        }
+            return true;
+        }
+    return true;
+}
+
+bool parseStartTag(Context& context)
+{
+    if (!readToken(context))
+        return false;
     if (context.token.type != Token::nameType)
-        throw SyntaxException(context.token.pos, "Expected tag name");
-    std::string elementName = std::move(context.token.value);
-    xsdcpp::ElementContext elementContext = enterElement(context, parentElementContext, elementName);
+        return fail(context, context.token.pos, xsd::error::expected_tag_name);
+    if (!enterElement(context, context.token.value, context.token.length))
+        return false;
+    const Frame& frame = context.stack.back();
     for (;;)
     {
-        readToken(context);
+        if (!readToken(context))
+            return false;
         if (context.token.type == Token::emptyTagEndType)
         {
-            checkAttributes(context, elementContext);
-            checkElement(context, elementContext);
-            return;
+            if (!checkAttributes(context, frame))
+                return false;
+            startElement(context);
+            if (!checkElement(context, frame))
+                return false;
+            leaveElement(context);
+            return true;
         }
         if (context.token.type == Token::tagEndType)
             break;
         if (context.token.type == Token::nameType)
         {
-            std::string attributeName = std::move(context.token.value);
-            readToken(context);
+            const char* attributeName = context.token.value;
+            size_t attributeNameLength = context.token.length;
+            if (!readToken(context))
+                return false;
             if (context.token.type != Token::equalsSignType)
-                throw SyntaxException(context.token.pos, "Expected '='");
-            readToken(context);
+                return fail(context, context.token.pos, xsd::error::expected_equals_sign);
+            if (!readToken(context))
+                return false;
             if (context.token.type != Token::stringType)
-                throw SyntaxException(context.token.pos, "Expected string");
-            std::string& attributeValue = context.token.value;
-            setAttribute(context, elementContext, std::move(attributeName), std::move(attributeValue));
+                return fail(context, context.token.pos, xsd::error::expected_string);
+            if (!setAttribute(context, frame, attributeName, attributeNameLength, context.token.value, context.token.length))
+                return false;
             continue;
         }
     }
-    checkAttributes(context, elementContext);
-    for (;;)
+    if (!checkAttributes(context, frame))
+        return false;
+    startElement(context);
+    return true;
+}
+
+bool parseEndTag(Context& context)
+{
+    const Frame& frame = context.stack.back();
+    if (!readToken(context))
+        return false;
+    if (context.token.type != Token::nameType)
+        return fail(context, context.token.pos, xsd::error::expected_tag_name);
+    const char* elementName = context.names.data() + frame.nameOffset;
+    if (context.token.length != frame.nameLength || memcmp(context.token.value, elementName, frame.nameLength) != 0)
+        return fail(context, context.token.pos, xsd::error::expected_end_tag, nullptr, elementName, frame.nameLength);
+    if (!readToken(context))
+        return false;
+    if (context.token.type != Token::tagEndType)
+        return fail(context, context.token.pos, xsd::error::expected_tag_end);
+    if (!checkElement(context, frame))
+        return false;
+    leaveElement(context);
+    return true;
+}
+
+// Makes sure that the tag at the current position ends within the input, so that it is not processed partially.
+bool checkTagComplete(Context& context)
+{
+    char quote = 0;
+    for (const char* p = context.pos; p != context.end; ++p)
     {
-        if (elementContext.info->flags & xsdcpp::ElementInfo::ReadTextFlag)
+        if (quote)
         {
-            const char* start = context.pos.pos;
-            if (elementContext.info->flags & xsdcpp::ElementInfo::SkipProcessingFlag)
-                skipTextAndSubElements(context, elementName);
-            else
-                skipText(context.pos);
-            if (context.pos.pos != start)
+            if (*p == quote)
+                quote = 0;
+        }
+        else if (*p == '>')
+            return true;
+        else if (*p == '"' || *p == '\'')
+            quote = *p;
+    }
+    return (context.needMoreData = true), false;
+}
+
+bool addText(Context& context, const Frame& frame, const char* text, size_t length)
+{
+    const xsdcpp::ElementContext& elementContext = frame.elementContext;
+    if (xsd::error::code_t code = elementContext.info->addText(elementContext.element, text, length))
+        return fail(context, context.pos, code, frame.childInfo->name, text, length);
+    return true;
+}
+
+bool readText(Context& context, const Frame& frame)
+{
+    const xsdcpp::ElementContext& elementContext = frame.elementContext;
+    bool comments;
+    if (elementContext.info->flags & xsdcpp::ElementInfo::ReadTextFlag)
+    {
+        const char* start = context.pos;
+        if (elementContext.info->flags & xsdcpp::ElementInfo::SkipProcessingFlag)
+        {
+            if (!skipTextAndSubElements(context, context.names.data() + frame.nameOffset, frame.nameLength, comments))
+                return false;
+        }
+        else if (!skipText(context, comments))
+            return false;
+        if (context.pos != start)
+        {
+            // the text is passed to the setter without being copied unless comments have to be removed or entity
+            // references have to be decoded (the skipped content of sub elements is kept as it is though)
+            size_t length = context.pos - start;
+            bool unescape = !(elementContext.info->flags & xsdcpp::ElementInfo::SkipProcessingFlag) && memchr(start, '&', length);
+            if (!comments && !unescape)
+                return addText(context, frame, start, length);
+            if (context.decodeInPlace)
+                return addText(context, frame, start, decodeInPlace(context, start, length, comments, unescape));
+            context.buffer.clear();
+            stripComments(start, length, unescape, context.buffer);
+            return addText(context, frame, context.buffer.data(), context.buffer.size());
+        }
+        return true;
+    }
+    return skipText(context, comments);
+}
+
+bool skipProlog(Context& context)
+{
+    const char*& pos = context.pos;
+    if (!skipSpace(context))
+        return false;
+    while (startsWith(context, pos, "<?", 2))
+    {
+        for (pos += 2;;)
+        {
+            pos = scan(context, CharClass<'?'>(), pos);
+            if (pos == context.end)
+                return unexpectedEnd(context);
+            if (startsWith(context, pos, "?>", 2))
             {
-                std::string text = stripComments(start, context.pos.pos - start);
-                elementContext.info->addText(elementContext.element, context.pos, std::move(text));
+                pos += 2;
+                break;
             }
+            ++pos;
         }
-        else
-            skipText(context.pos);
-        
-        readToken(context);
-        if (context.token.type == Token::endTagBeginType)
-            break;
-        if (context.token.type == Token::startTagBeginType)
+        if (!skipSpace(context))
+            return false;
+    }
+    return true;
+}
+
+
+// Parses text, start tags and end tags until the document element has been closed. Each of them is processed
+// either completely or, if the input ended within it, not at all. In the latter case `needMoreData` is set and
+// parsing can be resumed at `savedPos` when more input is available. Returns false if parsing did not complete.
+bool parseElements(Context& context)
+{
+    for (;;)
+    {
+        Frame& frame = context.stack.back();
+        if (!frame.textRead)
         {
-            parseElement(context, elementContext);
-            continue;
+            if (!(context.stack.size() == 1 ? skipProlog(context) : readText(context, frame)))
+                return false;
+            frame.textRead = true;
+            context.savedPos = context.pos;
+        }
+        if (context.stopAt && context.stack.size() == 2 && (context.pos >= context.stopAt || startsWith(context, context.pos, "</", 2)))
+            return true;
+        if (!context.final && !checkTagComplete(context))
+            return false;
+        if (!readToken(context))
+            return false;
+        if (context.token.type == Token::endTagBeginType && context.stack.size() > 1)
+        {
+            if (!parseEndTag(context))
+                return false;
+        }
+        else if (context.token.type == Token::startTagBeginType)
+        {
+            if (!parseStartTag(context))
+                return false;
         }
         else
-            throw SyntaxException(context.token.pos, "Expected '<'");
+            return fail(context, context.token.pos, xsd::error::expected_tag_start);
+        context.savedPos = context.pos;
+        if (context.stack.size() == 1)
+            return true;
     }
-    readToken(context);
-    if (context.token.type != Token::nameType)
-        throw SyntaxException(context.token.pos, "Expected tag name");
-    if (context.token.value != elementName)
-        throw SyntaxException(context.token.pos, "Expected end tag of '" + elementName + "'");
-    readToken(context);
-    if (context.token.type != Token::tagEndType)
-        throw SyntaxException(context.token.pos, "Expected '>'");
-    checkElement(context, elementContext);
 }
 
+void initContext(Context& context, const char** namespaces, const xsdcpp::ElementContext& elementContext, xsdcpp::ElementHandler* handler, size_t maxDepth)
+{
+    context.scanLevel = getScanLevel();
+    context.startOffset = 0;
+    context.startLocation.line = 1;
+    context.startLocation.column = 1;
+    context.needMoreData = false;
+    context.decodeInPlace = false;
+    context.namespaces = namespaces;
+    context.handler = handler;
+    context.stopAt = nullptr;
+    context.maxDepth = maxDepth;
+    pushFrame(context, elementContext.info, elementContext.element, nullptr, 0, 0);
 }
 
-namespace xsdcpp {
+// Lends the memory of the element stack and of the buffers of the previous context on the same thread to a
+// context, so that loading many small documents does not allocate them over and over again.
+class ContextMemory
+{
+public:
+    explicit ContextMemory(Context& context)
+        : _context(context)
+    {
+        Memory& memory = threadMemory();
+        _context.stack.swap(memory.stack);
+        _context.names.swap(memory.names);
+        _context.buffer.swap(memory.buffer);
+        _context.trackBits.swap(memory.trackBits);
+        _context.counters.swap(memory.counters);
+    }
+
+    ~ContextMemory()
+    {
+        Memory& memory = threadMemory();
+        _context.stack.clear();
+        _context.names.clear();
+        _context.buffer.clear();
+        _context.trackBits.clear();
+        _context.counters.clear();
+        if (_context.stack.capacity() <= maxFrames)
+            _context.stack.swap(memory.stack);
+        if (_context.names.capacity() <= maxBufferSize)
+            _context.names.swap(memory.names);
+        if (_context.buffer.capacity() <= maxBufferSize)
+            _context.buffer.swap(memory.buffer);
+        if (_context.trackBits.capacity() <= maxBufferSize / sizeof(uint64_t))
+            _context.trackBits.swap(memory.trackBits);
+        if (_context.counters.capacity() <= maxBufferSize / sizeof(uint32_t))
+            _context.counters.swap(memory.counters);
+    }
+
+private:
+    struct Memory
+    {
+        std::vector<Frame> stack;
+        std::string names;
+        std::string buffer;
+        std::vector<uint64_t> trackBits;
+        std::vector<uint32_t> counters;
+    };
+
+    static const size_t maxFrames = 1024; // memory of unusually deep or long documents is not kept
+    static const size_t maxBufferSize = 64 * 1024;
+
+    Context& _context;
+
+    static Memory& threadMemory()
+    {
+        static thread_local Memory memory;
+        return memory;
+    }
+
+    ContextMemory(const ContextMemory&);
+    ContextMemory& operator=(const ContextMemory&);
+};
+
+const size_t minChunkSize = 64 * 1024; // smaller parts of a document are not worth a thread
+
+struct Chunk
+{
+    Context context;
+    const char* start;
+    xsdcpp::create_element_t createRoot;
+    xsd::intern_table* internTable;
+    void* root;
+    bool failed;
+};
+
+// Owns the chunks of a document that is parsed in parallel and the threads that parse them.
+struct Chunks
+{
+    std::vector<Chunk> chunks;
+    std::vector<std::thread> threads;
+    xsdcpp::delete_element_t deleteRoot;
+
+    ~Chunks()
+    {
+        for (std::vector<std::thread>::iterator i = threads.begin(), end = threads.end(); i != end; ++i)
+            i->join();
+        for (std::vector<Chunk>::iterator i = chunks.begin(), end = chunks.end(); i != end; ++i)
+            deleteRoot(i->root);
+    }
+};
+
+// Finds a start tag of a repeated child element of the document element. The tag might as well be within a
+// comment or be the start tag of a nested element, which is detected when the chunks are merged. Returns nullptr if
+// there is no such tag in [p, end).
+const char* findSplitPoint(const Context& context, const xsdcpp::ElementInfo* info, const char* p)
+{
+    for (;; ++p)
+    {
+        if (p >= context.end)
+            return nullptr;
+        p = (const char*)memchr(p, '<', context.end - p);
+        if (!p)
+            return nullptr;
+        const char* name = p + 1;
+        const char* nameEnd = name;
+        while (nameEnd != context.end && !isXmlSpace(*nameEnd) && *nameEnd != '>' && *nameEnd != '/')
+            ++nameEnd;
+        if (nameEnd == context.end)
+            return nullptr;
+        if (nameEnd == name)
+            continue;
+        const xsdcpp::ChildElementInfo* childInfo = findChildElement(info, name, nameEnd - name);
+        if (childInfo && childInfo->appendElementField)
+            return p;
+    }
+}
 
-bool getListItem(const char*& s, std::string& result)
+void parseChunk(Chunk& chunk)
 {
-    while (isspace(*s))
-        ++s;
-    if (!*s)
+#ifdef XSDCPP_EXCEPTIONS
+    try
+#endif
+    {
+        // the strings of the chunk are interned in the table of the thread that loads the document
+        xsd::intern_table::scope internScope(chunk.internTable);
+        // the root is created on the thread that fills it, so that its memory is allocated by this thread
+        chunk.root = chunk.createRoot();
+        Frame& root = chunk.context.stack.front();
+        Frame& documentElement = chunk.context.stack.back();
+        root.elementContext.element = chunk.root;
+        documentElement.elementContext.element = documentElement.childInfo->getElementField(chunk.root);
+        if (!parseElements(chunk.context))
+            chunk.failed = true;
+    }
+#ifdef XSDCPP_EXCEPTIONS
+    catch (...)
+    {
+        chunk.failed = true;
+    }
+#endif
+}
+
+// Moves the elements that were parsed in a chunk to the document element. This fails if the chunk did not start
+// where the parsing of the preceding content ended, or if it could not be parsed or violates a maxOccurs
+// constraint. The content of the chunk has to be parsed again in that case to find the actual error.
+bool mergeChunk(Context& context, Chunk& chunk)
+{
+    if (chunk.failed || context.pos != chunk.start)
         return false;
-    const char* end = strpbrk(s, " \t\n\r");
-    if (end)
+    const Frame& frame = context.stack.back();
+    const Frame& chunkFrame = chunk.context.stack.back();
+    const xsdcpp::ElementContext& elementContext = frame.elementContext;
+    uint64_t* trackBits = context.trackBits.data() + frame.trackOffset;
+    uint32_t* counters = context.counters.data() + frame.counterOffset;
+    uint64_t* chunkTrackBits = chunk.context.trackBits.data() + chunkFrame.trackOffset;
+    const uint32_t* chunkCounters = chunk.context.counters.data() + chunkFrame.counterOffset;
+    for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
+        if (const xsdcpp::ChildElementInfo* c = i->children)
+            for (; c->name; ++c)
+                if (isTracked(chunkTrackBits, c->trackIndex))
+                {
+                    if (!c->appendElementField)
+                        return false;
+                    if (c->counterIndex != xsdcpp::ChildElementInfo::noCounter && c->maxOccurs && (uint64_t)counters[c->counterIndex] + chunkCounters[c->counterIndex] > c->maxOccurs)
+                        return false;
+                }
+
+    for (const xsdcpp::ElementInfo* i = elementContext.info; i; i = i->base)
+        if (const xsdcpp::ChildElementInfo* c = i->children)
+            for (; c->name; ++c)
+                if (isTracked(chunkTrackBits, c->trackIndex))
+                {
+                    c->appendElementField(elementContext.element, chunk.context.stack.back().elementContext.element);
+                    trackBits[c->trackIndex / 64] |= (uint64_t)1 << (c->trackIndex % 64);
+                    chunkTrackBits[c->trackIndex / 64] &= ~((uint64_t)1 << (c->trackIndex % 64)); // elements of a substitution group share a list
+                    if (c->counterIndex != xsdcpp::ChildElementInfo::noCounter)
+                    {
+                        uint64_t count = (uint64_t)counters[c->counterIndex] + chunkCounters[c->counterIndex];
+                        counters[c->counterIndex] = count < UINT32_MAX ? (uint32_t)count : UINT32_MAX;
+                    }
+                }
+
+    context.pos = chunk.context.pos;
+    return true;
+}
+
+struct PushContext
+{
+    Context context;
+    std::string input; // starts with the markup that could not be processed yet
+    size_t retrySize; // input size at which parsing is tried again
+    bool done;
+    bool failed; // the error is kept in the context
+};
+
+// Parses the input that has been written so far. Returns false if the document is invalid.
+bool resume(PushContext& pushContext, bool final)
+{
+    Context& context = pushContext.context;
+    context.pos = context.savedPos;
+    context.start = pushContext.input.data();
+    context.end = pushContext.input.data() + pushContext.input.size();
+    context.final = final;
+    context.needMoreData = false;
+    if (parseElements(context))
+        pushContext.done = true;
+    else if (context.needMoreData)
     {
-        result = std::string(s, end - s);
-        s = end;
+        // wait until the input has doubled to avoid rescanning long text over and over again
+        pushContext.retrySize = 2 * (context.end - context.savedPos);
     }
     else
     {
-        result = s;
-        s += result.size();
+        pushContext.failed = true;
+        return false;
     }
     return true;
 }
 
-void parse(const char* data, const char** namespaces, ElementContext& elementContext)
+bool parseDocument(const char* data, size_t length, const char** namespaces, xsdcpp::ElementContext& elementContext, xsdcpp::ElementHandler* handler, size_t maxDepth, bool decodeInPlace, xsd::error& error)
 {
     Context context;
-    context.pos.pos = context.pos.lineStart = data;
-    context.pos.line = 1;
-    context.namespaces = namespaces;
-    
-    skipSpace(context.pos);
-    while (*context.pos.pos == '<' && context.pos.pos[1] == '?')
+    ContextMemory memory(context);
+    context.pos = context.start = data;
+    context.end = data + length;
+    context.final = true;
+    initContext(context, namespaces, elementContext, handler, maxDepth);
+    context.decodeInPlace = decodeInPlace;
+    if (parseElements(context))
+        return true;
+    error = std::move(context.error);
+    return false;
+}
+
+}
+
+namespace xsdcpp {
+
+bool getListItem(const char*& data, const char* end, const char*& item, size_t& length)
+{
+    while (data != end && isXmlSpace(*data))
+        ++data;
+    if (data == end)
+        return false;
+    item = data;
+    while (data != end && !isXmlSpace(*data))
+        ++data;
+    length = data - item;
+    return true;
+}
+
+const AttributeInfo namespaceAttribute = {"xmlns"};
+const AttributeInfo schemaLocationAttribute = {"schemaLocation"};
+
+const AttributeInfo* findEntryPointAttribute(const char* name, size_t length)
+{
+    if (length >= 5 && strncmp(name, "xmlns", 5) == 0 && (length == 5 || name[5] == ':'))
+        return &namespaceAttribute;
+    const char* localName;
+    size_t localNameLength;
+    if (isNamespaceQualified(name, length, localName, localNameLength))
     {
-        context.pos.pos += 2;
-        for (;;)
+        if (equals("noNamespaceSchemaLocation", localName, localNameLength) ||
+            equals("schemaLocation", localName, localNameLength))
+            return &schemaLocationAttribute;
+    }
+    return nullptr;
+}
+
+void throwError(const xsd::error& error)
+{
+#ifdef XSDCPP_EXCEPTIONS
+    throw std::runtime_error(error.message());
+#else
+    fprintf(stderr, "%s\n", error.message().c_str());
+    abort();
+#endif
+}
+
+bool parse(const char* data, size_t length, const char** namespaces, ElementContext& elementContext, ElementHandler* handler, size_t maxDepth, xsd::error& error)
+{
+    return parseDocument(data, length, namespaces, elementContext, handler, maxDepth, false, error);
+}
+
+bool parseInPlace(char* data, size_t length, const char** namespaces, ElementContext& elementContext, ElementHandler* handler, size_t maxDepth, xsd::error& error)
+{
+    return parseDocument(data, length, namespaces, elementContext, handler, maxDepth, true, error);
+}
+
+bool parseParallel(const char* data, size_t length, const char** namespaces, ElementContext& elementContext, size_t maxDepth, create_element_t createRoot, delete_element_t deleteRoot, size_t threads, xsd::error& error)
+{
+    Context context;
+    ContextMemory memory(context);
+    context.pos = context.start = data;
+    context.end = data + length;
+    context.final = true;
+    initContext(context, namespaces, elementContext, nullptr, maxDepth);
+    context.stopAt = data;
+    if (!parseElements(context)) // stops behind the start tag of the document element
+    {
+        error = std::move(context.error);
+        return false;
+    }
+
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (context.stack.size() == 2 && !(context.stack.back().elementContext.info->flags & ElementInfo::ReadTextFlag) &&
+        threads > 1 && (size_t)(context.end - context.pos) / threads >= minChunkSize)
+    {
+        const Frame& frame = context.stack.back();
+        size_t chunkSize = (context.end - context.pos) / threads;
+        Chunks chunks;
+        chunks.deleteRoot = deleteRoot;
+        chunks.chunks.reserve(threads - 1);
+        // the split candidates do not go past the end, even if a split point was found far behind a candidate
+        for (const char* p = context.pos + chunkSize; chunks.chunks.size() < threads - 1 && p < context.end;
+             p = (size_t)(context.end - p) > chunkSize ? p + chunkSize : context.end)
         {
-            const char* end = strpbrk(context.pos.pos, "\r\n?");
-            if (!end)
-                throw SyntaxException(context.pos, "Unexpected end of file");
-            if (*end == '?' && end[1] == '>')
-            {
-                context.pos.pos = end + 2;
+            if (!chunks.chunks.empty())
+                p = std::max(p, chunks.chunks.back().start + 1);
+            const char* start = findSplitPoint(context, frame.elementContext.info, p);
+            if (!start)
                 break;
+            chunks.chunks.emplace_back();
+            Chunk& chunk = chunks.chunks.back();
+            chunk.start = start;
+            chunk.createRoot = createRoot;
+            chunk.internTable = xsd::intern_table::current();
+            chunk.root = nullptr;
+            chunk.failed = false;
+            Context& chunkContext = chunk.context;
+            chunkContext.pos = chunkContext.start = start;
+            chunkContext.end = context.end;
+            chunkContext.final = true;
+            initContext(chunkContext, namespaces, ElementContext(elementContext.info, nullptr), nullptr, maxDepth);
+            chunkContext.stopAt = context.end;
+            chunkContext.names = context.names;
+            pushFrame(chunkContext, frame.elementContext.info, nullptr, frame.childInfo, frame.nameOffset, frame.nameLength);
+            if (chunks.chunks.size() > 1)
+                chunks.chunks[chunks.chunks.size() - 2].context.stopAt = start;
+        }
+
+        if (!chunks.chunks.empty())
+        {
+            chunks.threads.reserve(chunks.chunks.size());
+            for (std::vector<Chunk>::iterator i = chunks.chunks.begin(), end = chunks.chunks.end(); i != end; ++i)
+                chunks.threads.emplace_back(parseChunk, std::ref(*i));
+
+            context.stopAt = chunks.chunks.front().start;
+            bool parsed = parseElements(context);
+
+            for (std::vector<std::thread>::iterator i = chunks.threads.begin(), end = chunks.threads.end(); i != end; ++i)
+                i->join();
+            chunks.threads.clear();
+
+            for (std::vector<Chunk>::iterator i = chunks.chunks.begin(), end = chunks.chunks.end(); parsed && i != end && context.stack.size() == 2; ++i)
+            {
+                if (context.pos < i->start)
+                {
+                    context.stopAt = i->start;
+                    parsed = parseElements(context);
+                }
+                if (parsed)
+                    mergeChunk(context, *i);
+            }
+            if (!parsed)
+            {
+                error = std::move(context.error);
+                return false;
             }
-            context.pos.pos = end + 1;
-            skipSpace(context.pos);
         }
-        skipSpace(context.pos);
     }
-    readToken(context);
-    if (context.token.type != Token::startTagBeginType)
-        throw SyntaxException(context.token.pos, "Expected '<'");
-    parseElement(context, elementContext);
+
+    context.stopAt = nullptr;
+    if (context.stack.size() > 1 && !parseElements(context))
+    {
+        error = std::move(context.error);
+        return false;
+    }
+    return true;
 }
 
-uint32_t toNumeric(const Position& pos, const char* const* values, const std::string& value)
+void forEachParallel(size_t count, size_t threads, const std::function<void(size_t)>& function)
 {
-    for (const char* const* i = values; *i; ++i)
-        if (value == *i)
-            return (uint32_t)(i - values);
-    throw VerificationException(pos, "Unknown attribute value '" + value + "'");
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    threads = std::max((size_t)1, std::min(threads, count));
+    std::atomic<size_t> next(0);
+    struct Worker
+    {
+        static void run(std::atomic<size_t>& next, size_t count, const std::function<void(size_t)>& function)
+        {
+            for (size_t i; (i = next++) < count;)
+                function(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(Worker::run, std::ref(next), count, std::cref(function));
+    Worker::run(next, count, function);
+    for (std::vector<std::thread>::iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+        i->join();
 }
 
-std::string to_string(size_t val, size_t size, const char* const* values, const char* name)
+PushParser::PushParser(const char** namespaces, const ElementInfo* info, void* element, size_t maxDepth)
+{
+    PushContext* pushContext = new PushContext;
+    ElementContext elementContext(info, element);
+    initContext(pushContext->context, namespaces, elementContext, nullptr, maxDepth);
+    pushContext->context.savedPos = pushContext->context.start = pushContext->input.data();
+    pushContext->retrySize = 0;
+    pushContext->done = false;
+    pushContext->failed = false;
+    _context = pushContext;
+}
+
+PushParser::~PushParser()
+{
+    delete (PushContext*)_context;
+}
+
+void PushParser::write(const char* data, size_t length)
+{
+    xsd::error error;
+    if (!write(data, length, error))
+        throwError(error);
+}
+
+bool PushParser::write(const char* data, size_t length, xsd::error& error)
+{
+    PushContext& pushContext = *(PushContext*)_context;
+    if (pushContext.failed)
+        return (error = pushContext.context.error), false;
+    if (pushContext.done)
+        return true;
+
+    // drop the processed input and rebase the saved position
+    Context& context = pushContext.context;
+    const char* start = pushContext.input.data();
+    locate(context, start, context.savedPos, context.startLocation);
+    context.startOffset += context.savedPos - start;
+    pushContext.input.erase(0, context.savedPos - start);
+    pushContext.input.append(data, length);
+    context.savedPos = pushContext.input.data();
+
+    if (pushContext.input.size() >= pushContext.retrySize && !resume(pushContext, false))
+        return (error = context.error), false;
+    return true;
+}
+
+void PushParser::finish()
+{
+    xsd::error error;
+    if (!finish(error))
+        throwError(error);
+}
+
+bool PushParser::finish(xsd::error& error)
+{
+    PushContext& pushContext = *(PushContext*)_context;
+    if (pushContext.failed || (!pushContext.done && !resume(pushContext, true)))
+        return (error = pushContext.context.error), false;
+    return true;
+}
+
+const char* to_cstring(size_t val, size_t size, const char* const* values, const char* name)
 {
     if (val >= size)
+    {
+#ifdef XSDCPP_EXCEPTIONS
         throw std::invalid_argument("Invalid " + std::string(name) + " argument");
+#else
+        fprintf(stderr, "Invalid %s argument\n", name);
+        abort();
+#endif
+    }
     return values[val];
 }
 
-void set_string(std::string* obj, const Position&, std::string&& val) { if (obj->empty()) *obj = std::move(val); else *obj += val; }
-void set_uint64_t(uint64_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected unsigned 64-bit integer value"); }
-void set_int64_t(int64_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected 64-bit integer value"); }
-void set_uint32_t(uint32_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected unsigned 32-bit integer value"); }
-void set_int32_t(int32_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected 32-bit integer value"); }
-void set_uint16_t(uint16_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected unsigned 16-bit integer value"); }
-void set_int16_t(int16_t* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected 16-bit integer value"); }
-void set_float(float* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected single precision floating point value"); }
-void set_double(double* obj,  const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> *obj)) throw VerificationException(pos, "Expected double precision floating point value"); }
-void set_bool(bool* obj, const Position& pos, std::string&& val) { std::stringstream ss(val); if (!(ss >> std::boolalpha >> *obj)) throw VerificationException(pos, "Expected boolean value"); }
-
-std::string read_file(const std::string& filePath)
-{
-    std::fstream file;
-    file.exceptions(std::fstream::failbit | std::fstream::badbit);
-    file.open(filePath, std::fstream::in);
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+xsd::error::code_t set_uint64_t(uint64_t* obj, const char* data, size_t length) { return toUnsigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_uint64; }
+xsd::error::code_t set_int64_t(int64_t* obj, const char* data, size_t length) { return toSigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_int64; }
+xsd::error::code_t set_uint32_t(uint32_t* obj, const char* data, size_t length) { return toUnsigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_uint32; }
+xsd::error::code_t set_int32_t(int32_t* obj, const char* data, size_t length) { return toSigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_int32; }
+xsd::error::code_t set_uint16_t(uint16_t* obj, const char* data, size_t length) { return toUnsigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_uint16; }
+xsd::error::code_t set_int16_t(int16_t* obj, const char* data, size_t length) { return toSigned(data, length, *obj) ? xsd::error::none : xsd::error::expected_int16; }
+xsd::error::code_t set_float(float* obj, const char* data, size_t length) { return toFloat(data, length, *obj) ? xsd::error::none : xsd::error::expected_float; }
+xsd::error::code_t set_double(double* obj, const char* data, size_t length) { return toFloat(data, length, *obj) ? xsd::error::none : xsd::error::expected_double; }
+xsd::error::code_t set_bool(bool* obj, const char* data, size_t length) { return toBool(data, length, *obj) ? xsd::error::none : xsd::error::expected_bool; }
+
+FileContent::FileContent()
+    : _data(nullptr)
+    , _size(0)
+    , _mapped(false)
+{
+}
+
+bool FileContent::open(const std::string& filePath, xsd::error& error)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return fileError(filePath, error);
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= (uint64_t)SIZE_MAX)
+        if (HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+        {
+            _data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (_data)
+            {
+                _size = (size_t)size.QuadPart;
+                _mapped = true;
+            }
+        }
+    CloseHandle(file);
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd == -1)
+        return fileError(filePath, error);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size <= (uint64_t)SIZE_MAX)
+    {
+        void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+            _data = (const char*)data;
+            _size = (size_t)st.st_size;
+            _mapped = true;
+        }
+    }
+    close(fd);
+#endif
+    if (_mapped)
+        return true;
+
+    // the file cannot be mapped (e.g. it is empty or a pipe), so read it into a buffer
+    std::ifstream file;
+    file.open(filePath, std::ifstream::in | std::ifstream::binary);
+    if (!file.is_open())
+        return fileError(filePath, error);
+    char buffer[65536];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount())
+        _buffer.append(buffer, (size_t)file.gcount());
+    if (file.bad())
+        return fileError(filePath, error);
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return true;
+}
+
+bool FileContent::fileError(const std::string& filePath, xsd::error& error)
+{
+    error.code = xsd::error::file_error;
+    error.line = 0;
+    error.column = 0;
+    error.offset = 0;
+    error.name = nullptr;
+    error.text = filePath;
+    error.limit = 0;
+    return false;
+}
+
+FileContent::~FileContent()
+{
+    if (!_mapped)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+#else
+    munmap((void*)_data, _size);
+#endif
 }
 
 }
@@ -1,32 +1,52 @@
 
 #include <string>
+#include <vector>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 
 namespace xsdcpp {
 
 struct ElementContext;
-struct Position;
 struct ElementInfo;
+struct ChildElementInfo;
+struct AttributeInfo;
 
 typedef void* (*get_field_t)(void*);
-typedef void (*set_value_t)(void* obj, const Position&, std::string&&);
+typedef void (*remove_field_t)(void*);
+typedef void (*append_field_t)(void* parent, void* other);
+typedef std::function<void*()> create_element_t;
+typedef void (*delete_element_t)(void*);
+typedef xsd::error::code_t (*set_value_t)(void* obj, const char* data, size_t length);
 typedef void (*set_default_t)(void*);
 typedef void (*set_any_attribute_t)(void*, std::string&& name, std::string&& value);
+typedef const ChildElementInfo* (*find_child_t)(const char* name, size_t length);
+typedef const AttributeInfo* (*find_attribute_t)(const char* name, size_t length);
+typedef int (*find_enum_t)(const char* name, size_t length);
 
+// The children and attributes of an element are tracked with one bit each, starting with the ones of its most
+// basic base type. Children that can occur more than once a limited number of times or that have to occur more
+// than once also have an occurrence counter.
 struct ChildElementInfo
 {
+    static const size_t noCounter = ~(size_t)0;
+
     const char* name;
     size_t trackIndex;
+    size_t counterIndex; // or noCounter
     get_field_t getElementField;
     const ElementInfo* info;
     size_t minOccurs;
     size_t maxOccurs;
+    remove_field_t removeElementField; // drops the last element added with getElementField, if it was added to a list
+    append_field_t appendElementField; // moves the elements of the list of another parent to the end of the list
+    size_t handlerEvent; // unique among the child element infos of the generated code of a namespace
 };
 
 struct AttributeInfo
 {
     const char* name;
-    uint64_t trackBit;
+    size_t trackIndex;
     get_field_t getAttribute;
     set_value_t setValue;
     bool isMandatory;
@@ -41,48 +61,158 @@ struct ElementInfo
         ReadTextFlag = 0x02,
         SkipProcessingFlag = 0x04,
         AnyAttributeFlag = 0x08,
-        CheckChildrenFlag = 0x10,
+        CheckMinOccursFlag = 0x10, // a child has to occur more than once
     };
     
     size_t flags;
     set_value_t addText;
     const ChildElementInfo* children;
-    size_t childrenCount;
+    size_t trackCount; // tracked children and attributes including the ones of the base types
+    size_t counterCount;
     const AttributeInfo* attributes;
-    uint64_t checkAttributeMask;
+    const uint64_t* requiredChildren; // mask of the children with a minimum occurrence or nullptr
+    const uint64_t* checkAttributes; // mask of the attributes that are mandatory or have a default value or nullptr
     const ElementInfo* base;
     set_any_attribute_t setOtherAttribute;
+    find_child_t findChild; // resolves own and inherited child elements
+    find_attribute_t findAttribute; // resolves own and inherited attributes
 };
 
 struct ElementContext
 {
     const ElementInfo* info;
     void* element;
-    size_t processedElements2[64];
-    uint64_t processedAttributes2;
 
-    ElementContext(const ElementInfo* info, void* element);
+    ElementContext(const ElementInfo* info, void* element) : info(info), element(element) {}
 };
 
-void parse(const char* data, const char** namespaces, ElementContext& elementContext);
+extern const AttributeInfo namespaceAttribute; // xmlns and xmlns:*
+extern const AttributeInfo schemaLocationAttribute; // *:schemaLocation and *:noNamespaceSchemaLocation
 
-bool getListItem(const char*& s, std::string& result);
+const AttributeInfo* findEntryPointAttribute(const char* name, size_t length);
+
+// Receives the elements of a document while it is parsed. If endElement returns true for an element that was
+// added to a list of its parent, it is removed from the list again, so the list does not grow with the document.
+class ElementHandler
+{
+public:
+    virtual ~ElementHandler() {}
 
-uint32_t toNumeric(const Position& pos, const char* const* values, const std::string& value);
+    virtual void startElement(const ChildElementInfo& child, void* element) = 0; // attributes are set
+    virtual bool endElement(const ChildElementInfo& child, void* element) = 0; // text and child elements are set
+};
+
+// Throws the error as std::runtime_error or, if exceptions are disabled, prints its message and aborts.
+void throwError(const xsd::error& error);
+
+// Parses a document. The number of nested elements is limited to `maxDepth` unless it is 0. Returns false and
+// sets `error` if the document is invalid.
+bool parse(const char* data, size_t length, const char** namespaces, ElementContext& elementContext, ElementHandler* handler, size_t maxDepth, xsd::error& error);
+
+// Parses a document like `parse`, but removes comments and decodes entity references in the input buffer instead of
+// in a copy. The input is modified, which is possible since the decoded text is never longer than the raw text.
+bool parseInPlace(char* data, size_t length, const char** namespaces, ElementContext& elementContext, ElementHandler* handler, size_t maxDepth, xsd::error& error);
+
+// Parses the content of the document element on multiple threads. The content is split in front of start tags of
+// repeated child elements, which are parsed into separate root elements created with `createRoot` (on the thread
+// that parses them) and appended to the lists of the document element in document order. A split that turns out
+// to be wrong (e.g. because it was in a comment) is dropped and the part of the content is parsed again. The
+// current `xsd::intern_table` of the calling thread is current on those threads while they parse.
+bool parseParallel(const char* data, size_t length, const char** namespaces, ElementContext& elementContext, size_t maxDepth, create_element_t createRoot, delete_element_t deleteRoot, size_t threads, xsd::error& error);
+
+// Calls `function` for the indices 0 to `count` - 1 on a pool of `threads` threads (or one thread per core if
+// `threads` is 0). The indices are handed out in ascending order. `function` must not throw.
+void forEachParallel(size_t count, size_t threads, const std::function<void(size_t)>& function);
+
+// Parses a document that is provided in chunks of arbitrary size. Markup that is cut off at the end of
+// a chunk is kept until the next chunk arrives, so only the input of incomplete markup is buffered.
+// Errors are raised with throwError or, with the overloads that take an xsd::error, returned. Once an
+// error was reported, all further calls fail with the same error.
+class PushParser
+{
+public:
+    PushParser(const char** namespaces, const ElementInfo* info, void* element, size_t maxDepth);
+    ~PushParser();
 
-std::string to_string(size_t val, size_t size, const char* const* values, const char* name);
+    void write(const char* data, size_t length);
+    bool write(const char* data, size_t length, xsd::error& error);
+    void finish();
+    bool finish(xsd::error& error);
 
-void set_string(std::string* obj,const Position&, std::string&& val);
-void set_uint64_t(uint64_t* obj, const Position& pos, std::string&& val);
-void set_int64_t(int64_t* obj, const Position& pos, std::string&& val);
-void set_uint32_t(uint32_t* obj, const Position& pos, std::string&& val);
-void set_int32_t(int32_t* obj, const Position& pos, std::string&& val);
-void set_uint16_t(uint16_t* obj, const Position& pos, std::string&& val);
-void set_int16_t(int16_t* obj, const Position& pos, std::string&& val);
-void set_float(float* obj, const Position& pos, std::string&& val);
-void set_double(double* obj, const Position& pos, std::string&& val);
-void set_bool(bool* obj, const Position& pos, std::string&& val);
+private:
+    void* _context;
+
+    PushParser(const PushParser&);
+    PushParser& operator=(const PushParser&);
+};
+
+template <typename T, typename A>
+void appendList(std::vector<T, A>& list, std::vector<T, A>& other)
+{
+    if (list.empty())
+        list.swap(other);
+    else
+    {
+        list.reserve(list.size() + other.size());
+        for (typename std::vector<T, A>::iterator i = other.begin(), end = other.end(); i != end; ++i)
+            list.emplace_back(std::move(*i));
+        other.clear();
+    }
+}
 
-std::string read_file(const std::string& filePath);
+bool getListItem(const char*& data, const char* end, const char*& item, size_t& length);
+
+const char* to_cstring(size_t val, size_t size, const char* const* values, const char* name);
+
+// The value setters return xsd::error::none or the error code of an invalid value.
+template <typename T>
+xsd::error::code_t set_string(T* obj, const char* data, size_t length) { obj->append(data, length); return xsd::error::none; }
+template <typename T>
+xsd::error::code_t set_interned_string(T* obj, const char* data, size_t length) { *obj = T(data, length); return xsd::error::none; }
+template <typename T>
+xsd::error::code_t set_string_view(T* obj, const char* data, size_t length) { *obj = T(data, length); return xsd::error::none; }
+template <typename T>
+xsd::error::code_t set_enum(T* obj, find_enum_t findEnum, const char* data, size_t length)
+{
+    int value = findEnum(data, length);
+    if (value < 0)
+        return xsd::error::unknown_value;
+    *obj = (T)value;
+    return xsd::error::none;
+}
+
+xsd::error::code_t set_uint64_t(uint64_t* obj, const char* data, size_t length);
+xsd::error::code_t set_int64_t(int64_t* obj, const char* data, size_t length);
+xsd::error::code_t set_uint32_t(uint32_t* obj, const char* data, size_t length);
+xsd::error::code_t set_int32_t(int32_t* obj, const char* data, size_t length);
+xsd::error::code_t set_uint16_t(uint16_t* obj, const char* data, size_t length);
+xsd::error::code_t set_int16_t(int16_t* obj, const char* data, size_t length);
+xsd::error::code_t set_float(float* obj, const char* data, size_t length);
+xsd::error::code_t set_double(double* obj, const char* data, size_t length);
+xsd::error::code_t set_bool(bool* obj, const char* data, size_t length);
+
+// The content of a file, memory mapped if possible.
+class FileContent
+{
+public:
+    FileContent();
+    ~FileContent();
+
+    bool open(const std::string& filePath, xsd::error& error);
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const char* _data;
+    size_t _size;
+    bool _mapped;
+    std::string _buffer;
+
+    static bool fileError(const std::string& filePath, xsd::error& error);
+
+    FileContent(const FileContent&);
+    FileContent& operator=(const FileContent&);
+};
 
 }
@@ -5,91 +5,808 @@
 #define XSDCPP_H
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define XSDCPP_HAS_STRING_VIEW 1
+#include <string_view>
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define XSDCPP_EXCEPTIONS 1
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iosfwd>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#ifdef XSDCPP_ARENA
+#include <thread>
+#endif
+
 namespace xsd {
 
+#ifdef XSDCPP_ARENA
+
+// A monotonic memory resource for the data model. Memory is allocated from blocks of growing size in the order
+// in which the model is built and it is only released when the arena is reset or destroyed. Allocations are
+// thread-safe; each thread allocates from its own block.
+class arena
+{
+public:
+    explicit arena(size_t blockSize = 64 * 1024)
+        : _id(nextId())
+        , _owner(std::this_thread::get_id())
+        , _blocks(nullptr)
+        , _spare(nullptr)
+        , _blockSize(blockSize)
+    {
+        _cursor.pos = _cursor.end = nullptr;
+    }
+
+    ~arena()
+    {
+        release(_blocks);
+        ::operator delete(_spare);
+    }
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        Cursor* cursor = &_cursor;
+        if (std::this_thread::get_id() != _owner)
+        {
+            ThreadCursor& threadCursor = ThreadCursor::get();
+            if (threadCursor.id != _id)
+            {
+                threadCursor.id = _id;
+                threadCursor.pos = threadCursor.end = nullptr;
+            }
+            cursor = &threadCursor;
+        }
+        size_t padding = (alignment - (uintptr_t)cursor->pos % alignment) % alignment;
+        if (size + padding > (size_t)(cursor->end - cursor->pos))
+        {
+            grow(*cursor, size + alignment);
+            padding = (alignment - (uintptr_t)cursor->pos % alignment) % alignment;
+        }
+        char* result = cursor->pos + padding;
+        cursor->pos = result + size;
+        return result;
+    }
+
+    // Releases all memory of the arena except for the largest block, which is reused. The objects that were
+    // allocated from the arena must not be used (or destroyed) anymore and no other thread may allocate from
+    // the arena during the reset.
+    void reset()
+    {
+        for (Block* i = _blocks; i;)
+        {
+            Block* next = i->next;
+            if (_spare && _spare->size >= i->size)
+                ::operator delete(i);
+            else
+            {
+                ::operator delete(_spare);
+                _spare = i;
+            }
+            i = next;
+        }
+        _blocks = nullptr;
+        _id = nextId();
+        _cursor.pos = _cursor.end = nullptr;
+    }
+
+    // Constructs an object in the arena. The object does not have to be destroyed before the arena is reset.
+    template <typename T>
+    T* create()
+    {
+        scope scope(*this);
+        return new (allocate(sizeof(T), alignof(T))) T();
+    }
+
+    // The arena that is used by allocators that are constructed on the current thread
+    static arena*& current()
+    {
+        static thread_local arena* current = nullptr;
+        return current;
+    }
+
+    // Makes an arena the current arena of the current thread for the lifetime of the scope object.
+    class scope
+    {
+    public:
+        explicit scope(arena& arena)
+            : _previous(current())
+        {
+            current() = &arena;
+        }
+
+        ~scope()
+        {
+            current() = _previous;
+        }
+
+    private:
+        arena* _previous;
+
+        scope(const scope&);
+        scope& operator=(const scope&);
+    };
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size;
+    };
+
+    struct Cursor
+    {
+        char* pos;
+        char* end;
+    };
+
+    // The block of a thread other than the one that constructed the arena
+    struct ThreadCursor : Cursor
+    {
+        uint64_t id;
+
+        static ThreadCursor& get()
+        {
+            static thread_local ThreadCursor cursor = ThreadCursor();
+            return cursor;
+        }
+    };
+
+private:
+    uint64_t _id;
+    std::thread::id _owner;
+    Cursor _cursor;
+    std::mutex _mutex;
+    Block* _blocks;
+    Block* _spare;
+    size_t _blockSize;
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> id(0);
+        return ++id;
+    }
+
+    void grow(Cursor& cursor, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Block* block;
+        if (_spare && _spare->size - sizeof(Block) >= size)
+        {
+            block = _spare;
+            _spare = nullptr;
+        }
+        else
+        {
+            size_t blockSize = _blockSize;
+            while (blockSize - sizeof(Block) < size)
+                blockSize *= 2;
+            if (_blockSize < 16 * 1024 * 1024)
+                _blockSize *= 2;
+            block = (Block*)::operator new(blockSize);
+            block->size = blockSize;
+        }
+        block->next = _blocks;
+        _blocks = block;
+        cursor.pos = (char*)(block + 1);
+        cursor.end = (char*)block + block->size;
+    }
+
+    static void release(Block* block)
+    {
+        while (block)
+        {
+            Block* next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+
+    arena(const arena&);
+    arena& operator=(const arena&);
+};
+
+// Allocates from the arena that was current on the thread that constructed the allocator or from the heap
+// if there was none. Memory from an arena is not freed individually.
+template <typename T>
+class allocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    allocator()
+        : _arena(arena::current())
+    {
+    }
+
+    template <typename U>
+    allocator(const allocator<U>& other)
+        : _arena(other._arena)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if (_arena)
+            return (T*)_arena->allocate(n * sizeof(T), alignof(T));
+        return (T*)::operator new(n * sizeof(T));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (!_arena)
+            ::operator delete(p);
+    }
+
+    allocator select_on_container_copy_construction() const { return allocator(); }
+
+    friend bool operator==(const allocator& lh, const allocator& rh) { return lh._arena == rh._arena; }
+    friend bool operator!=(const allocator& lh, const allocator& rh) { return lh._arena != rh._arena; }
+
+private:
+    arena* _arena;
+
+    template <typename U>
+    friend class allocator;
+};
+
+typedef std::basic_string<char, std::char_traits<char>, allocator<char>> string;
+
+template <typename T>
+using vector = std::vector<T, allocator<T>>;
+
+#else
+
 typedef std::string string;
 
 template <typename T>
 using vector = std::vector<T>;
 
+#endif
+
+// A reference to characters that are owned by someone else. The string fields of a data model that was generated
+// with the option -v refer to the input buffer of the load, which has to outlive the model.
+class string_view
+{
+public:
+    string_view()
+        : _data("")
+        , _size(0)
+    {
+    }
+    string_view(const char* data)
+        : _data(data)
+        , _size(strlen(data))
+    {
+    }
+    string_view(const char* data, size_t length)
+        : _data(data)
+        , _size(length)
+    {
+    }
+    string_view(const std::string& other)
+        : _data(other.data())
+        , _size(other.size())
+    {
+    }
+
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+    size_t length() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const char* begin() const { return _data; }
+    const char* end() const { return _data + _size; }
+    char operator[](size_t index) const { return _data[index]; }
+    std::string str() const { return std::string(_data, _size); }
+    operator std::string() const { return str(); }
+#ifdef XSDCPP_HAS_STRING_VIEW
+    operator std::string_view() const { return std::string_view(_data, _size); }
+#endif
+
+    friend bool operator==(const string_view& lh, const string_view& rh) { return lh._size == rh._size && memcmp(lh._data, rh._data, lh._size) == 0; }
+    friend bool operator!=(const string_view& lh, const string_view& rh) { return !(lh == rh); }
+    friend bool operator==(const string_view& lh, const char* rh) { return lh == string_view(rh); }
+    friend bool operator!=(const string_view& lh, const char* rh) { return !(lh == rh); }
+    friend bool operator==(const char* lh, const string_view& rh) { return rh == lh; }
+    friend bool operator!=(const char* lh, const string_view& rh) { return !(rh == lh); }
+    friend bool operator==(const string_view& lh, const std::string& rh) { return lh == string_view(rh); }
+    friend bool operator!=(const string_view& lh, const std::string& rh) { return !(lh == rh); }
+    friend bool operator==(const std::string& lh, const string_view& rh) { return rh == lh; }
+    friend bool operator!=(const std::string& lh, const string_view& rh) { return !(rh == lh); }
+
+    template <typename C, typename T>
+    friend std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& stream, const string_view& string) { return stream.write(string.data(), string.size()); }
+
+private:
+    const char* _data;
+    size_t _size;
+};
+
+// An immutable string that shares its characters with equal strings that were created while the same
+// intern_table was current. Copies are cheap and strings that share their characters are compared by pointer.
+class interned_string
+{
+public:
+    interned_string()
+        : _entry(nullptr)
+    {
+    }
+    interned_string(const char* data);
+    interned_string(const char* data, size_t length);
+    interned_string(const std::string& other);
+
+    interned_string(const interned_string& other)
+        : _entry(other._entry)
+    {
+        acquire(_entry);
+    }
+
+    interned_string(interned_string&& other) noexcept
+        : _entry(other._entry)
+    {
+        other._entry = nullptr;
+    }
+
+    ~interned_string()
+    {
+        release(_entry);
+    }
+
+    interned_string& operator=(const interned_string& other)
+    {
+        acquire(other._entry);
+        release(_entry);
+        _entry = other._entry;
+        return *this;
+    }
+
+    interned_string& operator=(interned_string&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release(_entry);
+            _entry = other._entry;
+            other._entry = nullptr;
+        }
+        return *this;
+    }
+
+    const char* data() const { return _entry ? (const char*)(_entry + 1) : ""; }
+    const char* c_str() const { return data(); }
+    size_t size() const { return _entry ? _entry->size : 0; }
+    size_t length() const { return size(); }
+    bool empty() const { return size() == 0; }
+    std::string str() const { return std::string(data(), size()); }
+    operator std::string() const { return str(); }
+
+    friend bool operator==(const interned_string& lh, const interned_string& rh) { return lh._entry == rh._entry || (lh.size() == rh.size() && memcmp(lh.data(), rh.data(), lh.size()) == 0); }
+    friend bool operator!=(const interned_string& lh, const interned_string& rh) { return !(lh == rh); }
+    friend bool operator==(const interned_string& lh, const char* rh) { return strlen(rh) == lh.size() && memcmp(lh.data(), rh, lh.size()) == 0; }
+    friend bool operator!=(const interned_string& lh, const char* rh) { return !(lh == rh); }
+    friend bool operator==(const char* lh, const interned_string& rh) { return rh == lh; }
+    friend bool operator!=(const char* lh, const interned_string& rh) { return !(rh == lh); }
+    friend bool operator==(const interned_string& lh, const std::string& rh) { return rh.size() == lh.size() && memcmp(lh.data(), rh.data(), lh.size()) == 0; }
+    friend bool operator!=(const interned_string& lh, const std::string& rh) { return !(lh == rh); }
+    friend bool operator==(const std::string& lh, const interned_string& rh) { return rh == lh; }
+    friend bool operator!=(const std::string& lh, const interned_string& rh) { return !(rh == lh); }
+
+    template <typename C, typename T>
+    friend std::basic_ostream<C, T>& operator<<(std::basic_ostream<C, T>& stream, const interned_string& string) { return stream.write(string.data(), string.size()); }
+
+private:
+    // The characters of the string follow the entry.
+    struct Entry
+    {
+        std::atomic<size_t> refs; // 0 for entries that are never freed (in an arena, without an intern_table)
+        size_t size;
+        size_t hash;
+    };
+
+private:
+    Entry* _entry;
+
+    explicit interned_string(Entry* entry)
+        : _entry(entry)
+    {
+        acquire(_entry);
+    }
+
+    static size_t hash(const char* data, size_t length)
+    {
+        size_t hash = 2166136261U;
+        for (const char* end = data + length; data < end; ++data)
+            hash = (hash ^ (unsigned char)*data) * 16777619U;
+        return hash;
+    }
+
+    // Creates an entry with a reference count of 1 or an entry without reference count in `memory`.
+    static Entry* create(const char* data, size_t length, size_t hash, void* memory = nullptr)
+    {
+        Entry* entry;
+        if (memory)
+        {
+            entry = (Entry*)memory;
+            new (&entry->refs) std::atomic<size_t>(0);
+        }
+        else
+        {
+            entry = (Entry*)::operator new(sizeof(Entry) + length + 1);
+            new (&entry->refs) std::atomic<size_t>(1);
+        }
+        entry->size = length;
+        entry->hash = hash;
+        char* chars = (char*)(entry + 1);
+        memcpy(chars, data, length);
+        chars[length] = '\0';
+        return entry;
+    }
+
+    static void acquire(Entry* entry)
+    {
+        if (entry && entry->refs.load(std::memory_order_relaxed))
+            entry->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void release(Entry* entry)
+    {
+        if (entry && entry->refs.load(std::memory_order_relaxed) && entry->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            entry->refs.~atomic();
+            ::operator delete(entry);
+        }
+    }
+
+    friend class intern_table;
+};
+
+// The table that deduplicates the interned strings that are created on a thread while it is current. The table
+// holds a reference to each of its strings, so their characters are never allocated from an arena. It can be
+// current on several threads at once.
+class intern_table
+{
+public:
+    intern_table()
+        : _entries(nullptr)
+        , _capacity(0)
+        , _size(0)
+    {
+    }
+
+    ~intern_table()
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+            interned_string::release(_entries[i]);
+        delete[] _entries;
+    }
+
+    interned_string intern(const char* data, size_t length)
+    {
+        size_t hash = interned_string::hash(data, length);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_capacity)
+            for (size_t i = hash & (_capacity - 1);; i = (i + 1) & (_capacity - 1))
+            {
+                interned_string::Entry* entry = _entries[i];
+                if (!entry)
+                    break;
+                if (entry->hash == hash && entry->size == length && memcmp(entry + 1, data, length) == 0)
+                    return interned_string(entry);
+            }
+        if ((_size + 1) * 2 > _capacity)
+            grow();
+        interned_string::Entry* entry = interned_string::create(data, length, hash);
+        insert(entry);
+        ++_size;
+        return interned_string(entry);
+    }
+
+    // The table that is used for interned strings that are created on the current thread
+    static intern_table*& current()
+    {
+        static thread_local intern_table* current = nullptr;
+        return current;
+    }
+
+    // Makes a table (or no table) the current table of the current thread for the lifetime of the scope object.
+    class scope
+    {
+    public:
+        explicit scope(intern_table& table)
+            : _previous(current())
+        {
+            current() = &table;
+        }
+
+        explicit scope(intern_table* table)
+            : _previous(current())
+        {
+            current() = table;
+        }
+
+        ~scope()
+        {
+            current() = _previous;
+        }
+
+    private:
+        intern_table* _previous;
+
+        scope(const scope&);
+        scope& operator=(const scope&);
+    };
+
+private:
+    std::mutex _mutex;
+    interned_string::Entry** _entries;
+    size_t _capacity;
+    size_t _size;
+
+    void insert(interned_string::Entry* entry)
+    {
+        size_t i = entry->hash & (_capacity - 1);
+        while (_entries[i])
+            i = (i + 1) & (_capacity - 1);
+        _entries[i] = entry;
+    }
+
+    void grow()
+    {
+        interned_string::Entry** entries = _entries;
+        size_t capacity = _capacity;
+        _capacity = capacity ? capacity * 2 : 256;
+        _entries = new interned_string::Entry*[_capacity]();
+        for (size_t i = 0; i < capacity; ++i)
+            if (entries[i])
+                insert(entries[i]);
+        delete[] entries;
+    }
+
+    intern_table(const intern_table&);
+    intern_table& operator=(const intern_table&);
+};
+
+inline interned_string::interned_string(const char* data, size_t length)
+    : _entry(nullptr)
+{
+    if (intern_table* table = intern_table::current())
+        *this = table->intern(data, length);
+#ifdef XSDCPP_ARENA
+    else if (arena* arena = arena::current())
+        _entry = create(data, length, hash(data, length), arena->allocate(sizeof(Entry) + length + 1, alignof(Entry)));
+#endif
+    else
+        _entry = create(data, length, hash(data, length));
+}
+
+inline interned_string::interned_string(const char* data)
+    : interned_string(data, strlen(data))
+{
+}
+
+inline interned_string::interned_string(const std::string& other)
+    : interned_string(other.data(), other.size())
+{
+}
+
+// An optional value that is stored inline.
 template <typename T>
 class optional
 {
 public:
     optional()
-        : _data(nullptr)
+        : _present(false)
     {
     }
     optional(const optional& other)
-        : _data(other._data ? new T(*other._data) : nullptr)
+        : _present(other._present)
     {
+        if (_present)
+            new (&_value) T(other._value);
     }
 
-    optional(optional&& other)
+    optional(optional&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        : _present(other._present)
     {
-        _data = other._data;
-        other._data = nullptr;
+        if (_present)
+        {
+            new (&_value) T(std::move(other._value));
+            other.destroy();
+        }
     }
 
     optional(const T& other)
-        : _data(new T(other))
+        : _present(true)
     {
+        new (&_value) T(other);
     }
 
     optional(T&& other)
-        : _data(new T(std::move(other)))
+        : _present(true)
     {
+        new (&_value) T(std::move(other));
     }
 
     ~optional()
     {
-        delete _data;
+        destroy();
     }
 
     optional& operator=(const optional& other)
+    {
+        if (other._present)
+            *this = other._value;
+        else
+            destroy();
+        return *this;
+    }
+
+    optional& operator=(optional&& other) noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)
+    {
+        if (this == &other)
+            return *this;
+        if (other._present)
+        {
+            *this = std::move(other._value);
+            other.destroy();
+        }
+        else
+            destroy();
+        return *this;
+    }
+
+    optional& operator=(const T& other)
+    {
+        if (_present)
+            _value = other;
+        else
+        {
+            new (&_value) T(other);
+            _present = true;
+        }
+        return *this;
+    }
+
+    optional& operator=(T&& other)
+    {
+        if (_present)
+            _value = std::move(other);
+        else
+        {
+            new (&_value) T(std::move(other));
+            _present = true;
+        }
+        return *this;
+    }
+
+    operator bool() const { return _present; }
+
+    T& operator*() { return _value; }
+    const T& operator*() const { return _value; }
+    T* operator->() { return &_value; }
+    const T* operator->() const { return &_value; }
+
+    friend bool operator==(const optional& lh, const T& rh) { return lh._present && lh._value == rh; }
+    friend bool operator!=(const optional& lh, const T& rh) { return !lh._present || lh._value != rh; }
+    friend bool operator==(const T& lh, const optional& rh) { return rh._present && lh == rh._value; }
+    friend bool operator!=(const T& lh, const optional& rh) { return !rh._present || lh != rh._value; }
+    friend bool operator==(const optional& lh, const optional& rh) { return lh._present == rh._present && (!lh._present || lh._value == rh._value); }
+    friend bool operator!=(const optional& lh, const optional& rh) { return !(lh == rh); }
+
+private:
+    union
+    {
+        T _value;
+    };
+    bool _present;
+
+    void destroy()
+    {
+        if (!_present)
+            return;
+        _value.~T();
+        _present = false;
+    }
+};
+
+// An optional value that is stored on the heap. It is used for fields of a type that (indirectly) contains
+// the type of the field itself.
+template <typename T>
+class boxed_optional
+{
+public:
+    boxed_optional()
+        : _data(nullptr)
+    {
+    }
+    boxed_optional(const boxed_optional& other)
+        : _data(nullptr)
+    {
+        if (other._data)
+            _data = create(*other._data);
+    }
+
+    boxed_optional(boxed_optional&& other) noexcept
+        : _data(other._data)
+#ifdef XSDCPP_ARENA
+        , _allocator(other._allocator)
+#endif
+    {
+        other._data = nullptr;
+    }
+
+    boxed_optional(const T& other)
+        : _data(nullptr)
+    {
+        _data = create(other);
+    }
+
+    boxed_optional(T&& other)
+        : _data(nullptr)
+    {
+        _data = create(std::move(other));
+    }
+
+    ~boxed_optional()
+    {
+        destroy();
+    }
+
+    boxed_optional& operator=(const boxed_optional& other)
     {
         if (other._data)
         {
             if (_data)
                 *_data = *other._data;
             else
-                _data = new T(*other._data);
+                _data = create(*other._data);
         }
         else
-        {
-            delete _data;
-            _data = nullptr;
-        }
+            destroy();
         return *this;
     }
 
-    optional& operator=(optional&& other)
+    boxed_optional& operator=(boxed_optional&& other) noexcept
     {
-        if (_data)
-            delete _data;
+        if (this == &other)
+            return *this;
+        destroy();
         _data = other._data;
+#ifdef XSDCPP_ARENA
+        _allocator = other._allocator;
+#endif
         other._data = nullptr;
         return *this;
     }
 
-    optional& operator=(const T& other)
+    boxed_optional& operator=(const T& other)
     {
         if (_data)
             *_data = other;
         else
-            _data = new T(other);
+            _data = create(other);
         return *this;
     }
 
-    optional& operator=(T&& other)
+    boxed_optional& operator=(T&& other)
     {
         if (_data)
             *_data = std::move(other);
         else
-            _data = new T(std::move(other));
+            _data = create(std::move(other));
         return *this;
     }
 
@@ -100,15 +817,54 @@ public:
     T* operator->() { return _data; }
     const T* operator->() const { return _data; }
 
-    friend bool operator==(const optional& lh, const T& rh) { return lh._data && *lh._data == rh; }
-    friend bool operator!=(const optional& lh, const T& rh) { return !lh._data || *lh._data != rh; }
-    friend bool operator==(const T& lh, const optional& rh) { return rh._data && lh == rh._data; }
-    friend bool operator!=(const T& lh, const optional& rh) { return !rh._data || lh != rh._data; }
-    friend bool operator==(const optional& lh, const optional& rh) { return lh._data == rh._data || (lh._data && rh._data && *lh._data == *rh._data); }
-    friend bool operator!=(const optional& lh, const optional& rh) { return lh._data != rh._data && (!lh._data || !rh._data || *lh._data != *rh._data); }
+    friend bool operator==(const boxed_optional& lh, const T& rh) { return lh._data && *lh._data == rh; }
+    friend bool operator!=(const boxed_optional& lh, const T& rh) { return !lh._data || *lh._data != rh; }
+    friend bool operator==(const T& lh, const boxed_optional& rh) { return rh._data && lh == *rh._data; }
+    friend bool operator!=(const T& lh, const boxed_optional& rh) { return !rh._data || lh != *rh._data; }
+    friend bool operator==(const boxed_optional& lh, const boxed_optional& rh) { return lh._data == rh._data || (lh._data && rh._data && *lh._data == *rh._data); }
+    friend bool operator!=(const boxed_optional& lh, const boxed_optional& rh) { return lh._data != rh._data && (!lh._data || !rh._data || *lh._data != *rh._data); }
 
 private:
     T* _data;
+#ifdef XSDCPP_ARENA
+    allocator<T> _allocator;
+#endif
+
+    template <typename U>
+    T* create(U&& value)
+    {
+#ifdef XSDCPP_ARENA
+        T* data = _allocator.allocate(1);
+#ifdef XSDCPP_EXCEPTIONS
+        try
+        {
+            return new (data) T(std::forward<U>(value));
+        }
+        catch (...)
+        {
+            _allocator.deallocate(data, 1);
+            throw;
+        }
+#else
+        return new (data) T(std::forward<U>(value));
+#endif
+#else
+        return new T(std::forward<U>(value));
+#endif
+    }
+
+    void destroy()
+    {
+        if (!_data)
+            return;
+#ifdef XSDCPP_ARENA
+        _data->~T();
+        _allocator.deallocate(_data, 1);
+#else
+        delete _data;
+#endif
+        _data = nullptr;
+    }
 };
 
 template <typename T>
@@ -137,12 +893,132 @@ private:
     T _value;
 };
 
-struct any_attribute
+#ifdef XSDCPP_ARENA
+
+template <typename N>
+struct basic_any_attribute
+{
+    N name;
+    xsd::string value;
+
+    basic_any_attribute() {}
+    basic_any_attribute(const std::string& name, const std::string& value)
+        : name(name.data(), name.size())
+        , value(value.data(), value.size())
+    {
+    }
+};
+
+typedef basic_any_attribute<xsd::string> any_attribute;
+
+#else
+
+template <typename N>
+struct basic_any_attribute
 {
-    std::string name;
+    N name;
     xsd::string value;
 };
 
+typedef basic_any_attribute<std::string> any_attribute;
+
+#endif
+
+// An attribute with an interned name, as used in data models that are generated with the option -i
+typedef basic_any_attribute<interned_string> interned_any_attribute;
+
+// The reason why a document could not be loaded with one of the try_load functions. The message is only
+// formatted when it is requested.
+struct error
+{
+    enum code_t
+    {
+        none,
+        file_error, // the file `text` could not be opened
+
+        // syntax errors
+        unexpected_end,
+        new_line_in_string,
+        expected_name,
+        expected_tag_name,
+        expected_end_tag, // of the element `text`
+        expected_equals_sign,
+        expected_string,
+        expected_tag_end,
+        expected_tag_start,
+
+        // verification errors
+        unexpected_element,
+        unexpected_attribute,
+        repeated_attribute,
+        missing_attribute,
+        unknown_namespace,
+        unknown_value,
+        min_occurs,
+        max_occurs,
+        max_depth,
+        expected_uint64,
+        expected_int64,
+        expected_uint32,
+        expected_int32,
+        expected_uint16,
+        expected_int16,
+        expected_float,
+        expected_double,
+        expected_bool,
+    };
+
+    code_t code;
+    uint64_t line;
+    uint64_t column; // in bytes, computed like the line only when the error is reported
+    uint64_t offset; // of the markup at which the error was detected in the document
+    const char* name; // of the element or attribute in the schema the error refers to or nullptr
+    std::string text; // the name or value in the document or the path of the file the error refers to
+    size_t limit; // of the violated min_occurs, max_occurs or max_depth constraint
+
+    error() : code(none), line(0), column(0), offset(0), name(nullptr), limit(0) {}
+
+    explicit operator bool() const { return code != none; }
+
+    std::string message() const
+    {
+        if (code == file_error)
+            return "Could not open file '" + text + "'";
+        std::string result = (code < unexpected_element ? "Syntax error at line '" : "Error at line '") + std::to_string(line) + "': ";
+        switch (code)
+        {
+        case unexpected_end: return result + "Unexpected end of file";
+        case new_line_in_string: return result + "New line in string";
+        case expected_name: return result + "Expected name";
+        case expected_tag_name: return result + "Expected tag name";
+        case expected_end_tag: return result + "Expected end tag of '" + text + "'";
+        case expected_equals_sign: return result + "Expected '='";
+        case expected_string: return result + "Expected string";
+        case expected_tag_end: return result + "Expected '>'";
+        case expected_tag_start: return result + "Expected '<'";
+        case unexpected_element: return result + "Unexpected element '" + text + "'";
+        case unexpected_attribute: return result + "Unexpected attribute '" + text + "'";
+        case repeated_attribute: return result + "Repeated attribute '" + name + "'";
+        case missing_attribute: return result + "Missing attribute '" + name + "'";
+        case unknown_namespace: return result + "Unknown namespace '" + text + "'";
+        case unknown_value: return result + "Unknown attribute value '" + text + "'";
+        case min_occurs: return result + "Minimum occurrence of element '" + name + "' is " + std::to_string(limit);
+        case max_occurs: return result + "Maximum occurrence of element '" + name + "' is " + std::to_string(limit);
+        case max_depth: return result + "Maximum element depth is " + std::to_string(limit);
+        case expected_uint64: return result + "Expected unsigned 64-bit integer value";
+        case expected_int64: return result + "Expected 64-bit integer value";
+        case expected_uint32: return result + "Expected unsigned 32-bit integer value";
+        case expected_int32: return result + "Expected 32-bit integer value";
+        case expected_uint16: return result + "Expected unsigned 16-bit integer value";
+        case expected_int16: return result + "Expected 16-bit integer value";
+        case expected_float: return result + "Expected single precision floating point value";
+        case expected_double: return result + "Expected double precision floating point value";
+        case expected_bool: return result + "Expected boolean value";
+        default: return result + "Unknown error";
+        }
+    }
+};
+
 }
 
 #endif
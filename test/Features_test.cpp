@@ -6,13 +6,36 @@
 #include "SimpleTypeExtension.hpp"
 #include "Import.hpp"
 #include "Attributes.hpp"
+#include "Intern.hpp"
+#include "View.hpp"
 #include "Occurrence.hpp"
 #include "Example.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iostream>
 
+namespace {
+
+std::string loadError(const std::function<void()>& load)
+{
+    try
+    {
+        load();
+    }
+    catch (const std::exception& e)
+    {
+        return e.what();
+    }
+    return std::string();
+}
+
+}
+
 TEST(Features, Enums)
 {
     EXPECT_EQ(SimpleTypeExtension::XEnumZZ::A, (SimpleTypeExtension::XEnumZZ)0);
@@ -21,6 +44,7 @@ TEST(Features, Enums)
     EXPECT_EQ(to_string(SimpleTypeExtension::XEnumZZ::A), "A");
     EXPECT_EQ(to_string(SimpleTypeExtension::XEnumZZ::B), "B");
     EXPECT_EQ(to_string(SimpleTypeExtension::XEnumZZ::C), "C");
+    EXPECT_STREQ(to_cstring(SimpleTypeExtension::XEnumZZ::B), "B");
 }
 
 TEST(Features, SubstitutionGroup)
@@ -95,6 +119,60 @@ TEST(Features, Recursion)
         EXPECT_TRUE(main2.SubMain);
         EXPECT_TRUE(main2.SubMain->SubMain);
     }
+
+    {
+        Recursion::Node node;
+        Recursion::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+    <Node>
+      <Link><Target><Node><Leaf value="42"/></Node></Target></Link>
+    </Node>)", node);
+
+        ASSERT_TRUE(node.Link);
+        ASSERT_TRUE(node.Link->Target.Node);
+        EXPECT_FALSE(node.Link->Target.Node->Link);
+        ASSERT_TRUE(node.Link->Target.Node->Leaf);
+        EXPECT_EQ(node.Link->Target.Node->Leaf->value, 42);
+        EXPECT_FALSE(node.Leaf);
+    }
+
+    // only optional elements within a recursion are stored on the heap
+    EXPECT_TRUE((std::is_same<decltype(Recursion::MainType2::SubMain), xsd::boxed_optional<Recursion::MainType2>>::value));
+    EXPECT_TRUE((std::is_same<decltype(Recursion::Node::Link), xsd::boxed_optional<Recursion::Link>>::value));
+    EXPECT_TRUE((std::is_same<decltype(Recursion::Node::Leaf), xsd::optional<Recursion::Leaf>>::value));
+    EXPECT_TRUE((std::is_same<decltype(Example::Person::Country), xsd::optional<Example::Country>>::value));
+    EXPECT_TRUE(std::is_nothrow_move_constructible<Example::Person>::value);
+}
+
+TEST(Features, Recursion_MaxDepth)
+{
+    struct _
+    {
+        static std::string nested(int depth)
+        {
+            std::string data = "<Main1 channel=\"0\">\n";
+            for (int i = 1; i < depth; ++i)
+                data += "<SubMain channel=\"" + std::to_string(i) + "\">";
+            for (int i = 1; i < depth; ++i)
+                data += "</SubMain>";
+            return data + "\n</Main1>";
+        }
+    };
+
+    Recursion::MainType1 main1;
+    Recursion::load_data(_::nested(100), main1);
+    const Recursion::MainType1* element = &main1;
+    for (int i = 1; i < 100; ++i)
+    {
+        ASSERT_EQ(element->SubMain.size(), 1);
+        element = &element->SubMain[0];
+        EXPECT_EQ(element->channel, std::to_string(i));
+    }
+    EXPECT_TRUE(element->SubMain.empty());
+
+    EXPECT_EQ(loadError([&]() { Recursion::load_data(_::nested(101), main1); }), "Error at line '2': Maximum element depth is 100");
+    Recursion::Main1Parser parser;
+    std::string data = _::nested(101);
+    EXPECT_EQ(loadError([&]() { parser.write(data.data(), data.size()); parser.finish(main1); }), "Error at line '2': Maximum element depth is 100");
 }
 
 TEST(Features, SimpleTypeExtension)
@@ -250,6 +328,31 @@ TEST(Features, Attribute_Unexpected)
     }
 }
 
+TEST(Features, Attribute_Namespace)
+{
+    {
+        Example::List list;
+        Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<List xmlns="http://whatever.x/example" xmlns:other="http://whatever.x/example" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xsi:schemaLocation="http://whatever.x/example Example.xsd" other:noNamespaceSchemaLocation="Example.xsd">
+    <Person><Name age="40">John Smith</Name></Person>
+</List>)", list);
+        EXPECT_EQ(list.Person.size(), 1);
+    }
+    {
+        try
+        {
+            Example::List list;
+            Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<List xmlns:other="http://whatever.x/unknown"/>)", list);
+            FAIL();
+        }
+        catch(const std::exception& e)
+        {
+            EXPECT_EQ(std::string(e.what()), "Error at line '2': Unknown namespace 'http://whatever.x/unknown'");
+        }
+    }
+}
+
 TEST(Features, Element_Occurrence)
 {
     {
@@ -294,6 +397,604 @@ TEST(Features, Element_Occurrence)
 
 }
 
+TEST(Features, Element_Occurrence_Wide)
+{
+    struct _
+    {
+        static std::string data(const std::string& attributes, const std::string& children)
+        {
+            return "<Wide A68=\"68\"" + attributes + ">" + children + "<C65>65</C65><C66>a</C66><C66>b</C66></Wide>";
+        }
+    };
+
+    Occurrence::Wide wide;
+    Occurrence::load_data(_::data(" A0=\"0\" A67=\"67\"", "<C0>0</C0><C64>64</C64><C67>a</C67><C67>b</C67><C69>69</C69>"), wide);
+    EXPECT_EQ(*wide.A0, 0);
+    EXPECT_FALSE(wide.A1);
+    EXPECT_EQ(*wide.A67, 67);
+    EXPECT_EQ(wide.A68, 68);
+    EXPECT_EQ(wide.A69, 69);
+    EXPECT_EQ(*wide.C0, "0");
+    EXPECT_EQ(*wide.C64, "64");
+    EXPECT_EQ(wide.C65, "65");
+    EXPECT_EQ(wide.C66.size(), 2);
+    EXPECT_EQ(wide.C67.size(), 2);
+    EXPECT_EQ(*wide.C69, "69");
+
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data(_::data(" A66=\"1\" A66=\"2\"", ""), wide); }), "Error at line '1': Repeated attribute 'A66'");
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data("<Wide><C65/><C66/><C66/></Wide>", wide); }), "Error at line '1': Missing attribute 'A68'");
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data(_::data("", "<C69/><C69/>"), wide); }), "Error at line '1': Maximum occurrence of element 'C69' is 1");
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data(_::data("", "<C67/><C67/><C67/>"), wide); }), "Error at line '1': Maximum occurrence of element 'C67' is 2");
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data("<Wide A68=\"68\"><C66/><C66/></Wide>", wide); }), "Error at line '1': Minimum occurrence of element 'C65' is 1");
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data("<Wide A68=\"68\"><C65/><C66/></Wide>", wide); }), "Error at line '1': Minimum occurrence of element 'C66' is 2");
+}
+
+TEST(Features, TryLoadData)
+{
+    Example::List list;
+    xsd::error error;
+    EXPECT_TRUE(Example::try_load_data("<List><Person><Name age=\"40\">John</Name></Person></List>", list, error));
+    EXPECT_FALSE(error);
+    ASSERT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name.age, 40);
+
+    // the output is not modified if the document is invalid
+    std::string data = "<List>\n<Person><Name age=\"40\">John</Name><Country>XX</Country></Person></List>";
+    EXPECT_FALSE(Example::try_load_data(data, list, error));
+    EXPECT_EQ(error.code, xsd::error::unknown_value);
+    EXPECT_EQ(error.line, 2);
+    EXPECT_EQ(error.column, data.find("</Country>") - data.find('\n'));
+    EXPECT_EQ(error.offset, data.find("</Country>"));
+    EXPECT_STREQ(error.name, "Country");
+    EXPECT_EQ(error.text, "XX");
+    EXPECT_EQ(error.message(), "Error at line '2': Unknown attribute value 'XX'");
+    EXPECT_EQ(error.message(), loadError([&]() { Example::load_data(data, list); }));
+    ASSERT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name, "John");
+
+    EXPECT_FALSE(Example::try_load_data("<List><Person><Name age=\"40\">John</Name></Person><Person></List>", list, error));
+    EXPECT_EQ(error.code, xsd::error::expected_end_tag);
+    EXPECT_EQ(error.text, "Person");
+    EXPECT_EQ(error.message(), "Syntax error at line '1': Expected end tag of 'Person'");
+
+    EXPECT_FALSE(Example::try_load_data("<List><Person><Name>John</Name></Person></List>", list, error));
+    EXPECT_EQ(error.code, xsd::error::missing_attribute);
+    EXPECT_STREQ(error.name, "age");
+
+    Occurrence::Main main;
+    EXPECT_FALSE(Occurrence::try_load_data("<Main><MyElement name=\"a\"/><MyElement name=\"b\"/><MyElement name=\"c\"/><MyElement name=\"d\"/></Main>", main, error));
+    EXPECT_EQ(error.code, xsd::error::max_occurs);
+    EXPECT_STREQ(error.name, "MyElement");
+    EXPECT_EQ(error.limit, 3);
+
+    EXPECT_FALSE(Example::try_load_file("does_not_exist.xml", list, error));
+    EXPECT_EQ(error.code, xsd::error::file_error);
+    EXPECT_EQ(error.message(), "Could not open file 'does_not_exist.xml'");
+    EXPECT_EQ(error.message(), loadError([&]() { Example::load_file("does_not_exist.xml", list); }));
+}
+
+TEST(Features, Element_NamespacePrefix)
+{
+    Example::List list;
+    Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<ex:List xmlns:ex="http://whatever.x/example">
+    <ex:Person><ex:Name age="40">John Smith</ex:Name></ex:Person>
+</ex:List>
+)", list);
+    EXPECT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name, "John Smith");
+}
+
+TEST(Features, Element_EndTagMismatch)
+{
+    Example::List list;
+    try
+    {
+        Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<List>
+    <Person><Name age="40">John Smith</Names></Person>
+</List>
+)", list);
+        FAIL();
+    }
+    catch(const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Syntax error at line '3': Expected end tag of 'Name'");
+    }
+
+    // the name is reported as it is written in the document
+    try
+    {
+        Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<ex:List xmlns:ex="http://whatever.x/example">
+    <ex:Person><ex:Name age="40">John Smith</ex:Names></ex:Person>
+</ex:List>
+)", list);
+        FAIL();
+    }
+    catch(const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Syntax error at line '3': Expected end tag of 'ex:Name'");
+    }
+}
+
+TEST(Features, Element_Text)
+{
+    Example::List list;
+    Example::load_data(R"(<List>
+    <Person><Name age="40">John Smith</Name></Person>
+    <Person><Name age="41">Smith &amp; Sons &lt;Ltd&gt;<!-- & --> &#65;&#x42;</Name></Person>
+    <Person><Name age="42">Mary <!-- middle name? -->Jones</Name></Person>
+</List>
+)", list);
+    ASSERT_EQ(list.Person.size(), 3);
+    EXPECT_EQ(list.Person[0].Name, "John Smith");
+    EXPECT_EQ(list.Person[1].Name, "Smith & Sons <Ltd> AB");
+    EXPECT_EQ(list.Person[2].Name, "Mary Jones");
+}
+
+TEST(Features, LoadDataInPlace)
+{
+    std::string data = R"(<List>
+    <Person><Name age="40" comment="&quot;J&quot; &amp;&#10;S">Smith &amp; <!-- two
+lines --> Sons</Name></Person>
+    <Person><Name age="41">Mary <!-- middle name? -->Jones</Name></Person>
+</List>
+)";
+    Example::List list;
+    std::string buffer = data;
+    Example::load_data_in_place(&buffer[0], buffer.size(), list);
+    ASSERT_EQ(list.Person.size(), 2);
+    EXPECT_EQ(*list.Person[0].Name.comment, "\"J\" &\nS");
+    EXPECT_EQ(list.Person[0].Name, "Smith &  Sons");
+    EXPECT_EQ(list.Person[1].Name, "Mary Jones");
+
+    // errors behind decoded text are reported at the same line and column as without decoding in place
+    struct _
+    {
+        static void expectSameError(const std::string& data, uint64_t line)
+        {
+            Example::List list;
+            std::string buffer = data;
+            xsd::error error, expectedError;
+            EXPECT_FALSE(Example::try_load_data_in_place(&buffer[0], buffer.size(), list, error));
+            EXPECT_FALSE(Example::try_load_data(data, list, expectedError));
+            EXPECT_EQ(error.line, line);
+            EXPECT_EQ(error.line, expectedError.line);
+            EXPECT_EQ(error.column, expectedError.column);
+            EXPECT_EQ(error.offset, expectedError.offset);
+            EXPECT_EQ(error.message(), expectedError.message());
+        }
+    };
+    std::string invalid = data;
+    invalid.replace(invalid.find("41"), 2, "x");
+    _::expectSameError(invalid, 4);
+    invalid = data;
+    invalid.replace(invalid.find("</Name></Person>"), 7, "</Name><Country>XX</Country>");
+    _::expectSameError(invalid, 3);
+    invalid = data;
+    invalid.replace(invalid.find(">Smith"), 0, " hidden=\"x\"");
+    _::expectSameError(invalid, 2);
+}
+
+TEST(Features, PushParser)
+{
+    const std::string data = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!-- list of persons -->
+<List>
+    <Person>
+        <Name age="40" comment="&quot;J&quot;">John Smith</Name>
+        <Country comment="not sure">UK</Country>
+    </Person>
+    <!-- comment with <Person> -->
+    <Person>
+        <Name age="54" hidden="false">Mary <!-- middle name? -->Jones</Name>
+    </Person>
+</List>
+)";
+    for (size_t chunkSize = 1; chunkSize <= data.size(); ++chunkSize)
+    {
+        Example::List list;
+        Example::ListParser parser;
+        for (size_t i = 0; i < data.size(); i += chunkSize)
+            parser.write(data.c_str() + i, std::min(chunkSize, data.size() - i));
+        parser.finish(list);
+        ASSERT_EQ(list.Person.size(), 2);
+        EXPECT_EQ(list.Person[0].Name, "John Smith");
+        EXPECT_EQ(list.Person[0].Name.age, 40);
+        EXPECT_EQ(*list.Person[0].Name.comment, "\"J\"");
+        EXPECT_EQ(*list.Person[0].Country, Example::CountryCode::UK);
+        EXPECT_EQ(list.Person[1].Name, "Mary Jones");
+        EXPECT_EQ(list.Person[1].Name.hidden, false);
+    }
+
+    for (size_t chunkSize = 1; chunkSize <= data.size(); ++chunkSize)
+    {
+        try
+        {
+            Example::List list;
+            Example::ListParser parser;
+            for (size_t i = 0; i < data.size() - 10; i += chunkSize)
+                parser.write(data.c_str() + i, std::min(chunkSize, data.size() - 10 - i));
+            parser.finish(list);
+            FAIL();
+        }
+        catch (const std::exception& e)
+        {
+            EXPECT_EQ(std::string(e.what()), "Syntax error at line '11': Unexpected end of file");
+        }
+    }
+
+    try
+    {
+        Example::List list;
+        Example::ListParser parser;
+        parser.write(data.c_str(), data.find("<Name"));
+        parser.write("<Nam", 4);
+        parser.write("e age=\"x\">", 10);
+        FAIL();
+    }
+    catch (const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Error at line '5': Expected 32-bit integer value");
+    }
+
+    // once an error was reported, further input is not parsed
+    Example::List list;
+    Example::ListParser parser;
+    xsd::error error;
+    EXPECT_TRUE(parser.try_write(data.c_str(), data.find("<Name"), error));
+    EXPECT_FALSE(parser.try_write("<Name age=\"x\">", 14, error));
+    EXPECT_EQ(error.code, xsd::error::expected_int32);
+    EXPECT_STREQ(error.name, "age");
+    error = xsd::error();
+    EXPECT_FALSE(parser.try_finish(list, error));
+    EXPECT_EQ(error.code, xsd::error::expected_int32);
+}
+
+TEST(Features, LoadFile)
+{
+    const char* filePath = "Features_test.xml";
+    std::string data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<List><Person><Name age=\"40\">John Smith</Name></Person>";
+    data.append(4096 - data.size() - 7, ' ');
+    data.append("</List>");
+    {
+        std::ofstream file(filePath, std::ofstream::out | std::ofstream::binary);
+        file << data;
+    }
+    Example::List list;
+    Example::load_file(filePath, list);
+    EXPECT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name, "John Smith");
+
+    // the end of the file is at a page boundary
+    {
+        std::ofstream file(filePath, std::ofstream::out | std::ofstream::binary);
+        file << data.substr(0, data.size() - 1) << ' ';
+    }
+    try
+    {
+        Example::load_file(filePath, list);
+        FAIL();
+    }
+    catch (const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Syntax error at line '2': Unexpected end of file");
+    }
+    std::remove(filePath);
+}
+
+TEST(Features, LoadData_Range)
+{
+    std::string buffer = "<List><Person><Name age=\"40\">John Smith</Name></Person></List><List>";
+    size_t length = buffer.find("</List>") + 7;
+    Example::List list;
+    Example::load_data(buffer.data(), length, list);
+    EXPECT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name, "John Smith");
+
+    try
+    {
+        Example::load_data(buffer.data(), length - 1, list);
+        FAIL();
+    }
+    catch (const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Syntax error at line '1': Unexpected end of file");
+    }
+
+#ifdef XSDCPP_HAS_STRING_VIEW
+    Example::List list2;
+    Example::load_data(std::string_view(buffer).substr(0, length), list2);
+    EXPECT_EQ(list2.Person.size(), 1);
+#endif
+}
+
+TEST(Features, Handler)
+{
+    struct Handler : Example::ListHandler
+    {
+        std::string events;
+        size_t persons = 0;
+
+        void on_start_Person(const Example::Person&) override { events += "<Person>"; }
+        void on_end_Person(const Example::Person& person) override
+        {
+            events += "</Person>";
+            ++persons;
+            EXPECT_EQ(person.Name, persons == 1 ? "John Smith" : "Mary Jones");
+        }
+        void on_start_Name(const Example::Name& name) override
+        {
+            events += "<Name age=" + std::to_string(name.age) + ">";
+            EXPECT_TRUE(name.empty());
+        }
+        void on_end_Name(const Example::Name& name) override { events += name + "</Name>"; }
+        void on_end_Country(const Example::Country& country) override { events += std::string("<Country/>") + to_cstring(country); }
+        void on_end_List(const Example::List& list) override
+        {
+            events += "</List>";
+            EXPECT_TRUE(list.Person.empty());
+        }
+    } handler;
+
+    Example::parse_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<List>
+    <Person>
+        <Name age="40">John Smith</Name>
+        <Country comment="not sure">UK</Country>
+    </Person>
+    <Person>
+        <Name age="54" hidden="false">Mary Jones</Name>
+    </Person>
+</List>
+)", handler);
+    EXPECT_EQ(handler.persons, 2);
+    EXPECT_EQ(handler.events, "<Person><Name age=40>John Smith</Name><Country/>UK</Person><Person><Name age=54>Mary Jones</Name></Person></List>");
+}
+
+TEST(Features, Callbacks)
+{
+    std::vector<std::string> names;
+    Example::ListCallbacks callbacks;
+    callbacks.List_Person = [&](Example::Person& person) {
+        EXPECT_EQ(*person.Country, Example::CountryCode::UK);
+        names.push_back(std::move(person.Name));
+    };
+    Example::List list;
+    Example::load_data(R"(<?xml version="1.0" encoding="UTF-8"?>
+<List>
+    <Person>
+        <Name age="40">John Smith</Name>
+        <Country>UK</Country>
+    </Person>
+    <Person>
+        <Name age="54">Mary Jones</Name>
+        <Country>UK</Country>
+    </Person>
+</List>
+)", list, callbacks);
+    EXPECT_TRUE(list.Person.empty());
+    EXPECT_EQ(names, std::vector<std::string>({"John Smith", "Mary Jones"}));
+
+    try
+    {
+        Example::load_data("<List></List>", list, callbacks);
+        FAIL();
+    }
+    catch (const std::exception& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "Error at line '1': Minimum occurrence of element 'Person' is 1");
+    }
+}
+
+TEST(Features, LoadParallel)
+{
+    std::string data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<List>\n";
+    for (int i = 0; i < 10000; ++i)
+    {
+        data += "    <Person>\n        <Name age=\"" + std::to_string(i) + "\">Person " + std::to_string(i) + "</Name>\n    </Person>\n";
+        if (i % 7 == 0)
+            data += "    <!-- <Person><Name age=\"-1\">Nobody</Name></Person> -->\n";
+    }
+    data += "</List>\n";
+
+    Example::List expected;
+    Example::load_data(data, expected);
+    for (size_t threads = 1; threads <= 8; ++threads)
+    {
+        Example::List list;
+        Example::load_data_parallel(data.data(), data.size(), list, threads);
+        ASSERT_EQ(list.Person.size(), expected.Person.size());
+        for (size_t i = 0; i < list.Person.size(); ++i)
+        {
+            EXPECT_EQ(list.Person[i].Name, expected.Person[i].Name);
+            EXPECT_EQ(list.Person[i].Name.age, expected.Person[i].Name.age);
+        }
+    }
+
+    // errors are reported at the same line as without threads
+    std::string invalidData = data;
+    invalidData.replace(invalidData.find("age=\"8000\""), 10, "age=\"x\"");
+    Example::List list;
+    std::string error = loadError([&]() { Example::load_data(invalidData, list); });
+    EXPECT_EQ(error, "Error at line '25147': Expected 32-bit integer value");
+    EXPECT_EQ(loadError([&]() { Example::load_data_parallel(invalidData.data(), invalidData.size(), list, 4); }), error);
+}
+
+TEST(Features, LoadParallel_Occurrence)
+{
+    std::string data = "<Main>\n";
+    for (int i = 0; i < 4; ++i)
+    {
+        data += "<MyElement name=\"" + std::to_string(i) + "\"/>";
+        data.append(100000, '\n');
+    }
+    data += "</Main>";
+    Occurrence::Main main;
+    EXPECT_EQ(loadError([&]() { Occurrence::load_data_parallel(data.data(), data.size(), main, 4); }), "Error at line '300002': Maximum occurrence of element 'MyElement' is 3");
+}
+
+TEST(Features, LoadParallel_LargeComment)
+{
+    // the first split point is found far behind the first chunk boundary
+    std::string data = "<List>\n    <Person><Name age=\"0\">Person 0</Name></Person>\n    <!--";
+    data.append(1000000, ' ');
+    data += "-->\n";
+    for (int i = 1; i < 4; ++i)
+        data += "    <Person><Name age=\"" + std::to_string(i) + "\">Person " + std::to_string(i) + "</Name></Person>\n";
+    data += "</List>\n";
+
+    for (size_t threads = 2; threads <= 8; ++threads)
+    {
+        Example::List list;
+        Example::load_data_parallel(data.data(), data.size(), list, threads);
+        ASSERT_EQ(list.Person.size(), 4);
+        for (size_t i = 0; i < list.Person.size(); ++i)
+            EXPECT_EQ(list.Person[i].Name, "Person " + std::to_string(i));
+    }
+}
+
+TEST(Features, LoadFiles)
+{
+    std::vector<std::string> filePaths;
+    for (int i = 0; i < 20; ++i)
+    {
+        filePaths.push_back("Features_test_" + std::to_string(i) + ".xml");
+        std::ofstream file(filePaths.back(), std::ofstream::out | std::ofstream::binary);
+        file << "<List>\n<Person><Name age=\"" << (i == 7 ? std::string("x") : std::to_string(i)) << "\">Person " << i << "</Name></Person>\n</List>";
+    }
+    filePaths.insert(filePaths.begin() + 3, "Features_test_missing.xml");
+
+    for (size_t threads = 1; threads <= 4; ++threads)
+    {
+        std::vector<Example::List> lists;
+        std::vector<xsd::error> errors = Example::load_files(filePaths, lists, threads);
+        ASSERT_EQ(lists.size(), filePaths.size());
+        ASSERT_EQ(errors.size(), filePaths.size());
+        for (size_t i = 0; i < filePaths.size(); ++i)
+        {
+            if (i == 3)
+                EXPECT_EQ(errors[i].message(), "Could not open file 'Features_test_missing.xml'");
+            else if (i == 8)
+            {
+                EXPECT_EQ(errors[i].code, xsd::error::expected_int32);
+                EXPECT_EQ(errors[i].message(), "Error at line '2': Expected 32-bit integer value");
+            }
+            else
+            {
+                int index = (int)(i < 3 ? i : i - 1);
+                EXPECT_FALSE(errors[i]);
+                ASSERT_EQ(lists[i].Person.size(), 1);
+                EXPECT_EQ(lists[i].Person[0].Name, "Person " + std::to_string(index));
+                EXPECT_EQ(lists[i].Person[0].Name.age, index);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < filePaths.size(); ++i)
+        std::remove(filePaths[i].c_str());
+}
+
+TEST(Features, InternStrings)
+{
+    std::string data = "<ItemList>\n";
+    for (int i = 0; i < 1000; ++i)
+        data += "<Item category=\"" + std::string(i % 2 ? "fruit" : "vegetable") + "\"" + (i % 3 ? "" : " label=\"sale\"") + " count=\"" + std::to_string(i) + "\" origin=\"local\" code=\"ABC\" grade=\"B\"/>\n";
+    data += "</ItemList>";
+
+    Intern::ItemList list;
+    Intern::load_data(data, list);
+    ASSERT_EQ(list.Item.size(), 1000);
+    static_assert(std::is_same<decltype(list.Item[0].category), xsd::interned_string>::value, "");
+    static_assert(std::is_same<decltype(list.Item[0].label), xsd::optional<xsd::interned_string>>::value, "");
+    static_assert(std::is_same<decltype(list.Item[0].code), xsd::optional<xsd::interned_string>>::value, "");
+    static_assert(std::is_same<decltype(list.Item[0].grade), xsd::optional<Intern::Grade>>::value, "");
+    EXPECT_EQ(list.Item[0].category, "vegetable");
+    EXPECT_EQ(list.Item[1].category, "fruit");
+    EXPECT_EQ(list.Item[1].unit, "pcs");
+    EXPECT_EQ(*list.Item[0].label, "sale");
+    EXPECT_FALSE(list.Item[1].label);
+    EXPECT_EQ(*list.Item[5].count, 5);
+    static_assert(std::is_same<decltype(list.Item[5].other_attributes[0].name), xsd::interned_string>::value, "");
+    ASSERT_EQ(list.Item[5].other_attributes.size(), 1);
+    EXPECT_EQ(list.Item[5].other_attributes[0].name, "origin");
+    EXPECT_EQ(list.Item[5].other_attributes[0].value, "local");
+
+    // equal values share their characters
+    EXPECT_EQ(list.Item[1].category.data(), list.Item[999].category.data());
+    EXPECT_EQ(list.Item[0].category.data(), list.Item[998].category.data());
+    EXPECT_NE(list.Item[0].category.data(), list.Item[1].category.data());
+    EXPECT_EQ(list.Item[0].label->data(), list.Item[999].label->data());
+    EXPECT_EQ(list.Item[3].unit.data(), list.Item[4].unit.data());
+    EXPECT_EQ(list.Item[0].code->data(), list.Item[999].code->data());
+    EXPECT_EQ(*list.Item[0].code, "ABC");
+    EXPECT_EQ(*list.Item[0].grade, Intern::Grade::B);
+    EXPECT_EQ(list.Item[0].other_attributes[0].name.data(), list.Item[999].other_attributes[0].name.data());
+
+    // a table can be shared across loads and by the chunks of a parallel load
+    std::string parallelData = "<ItemList>\n";
+    for (int i = 0; i < 20000; ++i)
+        parallelData += "<Item category=\"" + std::string(i % 2 ? "fruit" : "vegetable") + "\"" + (i % 3 ? "" : " label=\"sale\"") + " count=\"" + std::to_string(i) + "\" origin=\"local\" code=\"ABC\" grade=\"B\"/>\n";
+    parallelData += "</ItemList>";
+    xsd::intern_table table;
+    xsd::intern_table::scope scope(table);
+    Intern::ItemList list1, list2;
+    Intern::load_data(data, list1);
+    Intern::load_data_parallel(parallelData.data(), parallelData.size(), list2, 4);
+    EXPECT_EQ(list1.Item[1].category.data(), list1.Item[3].category.data());
+    EXPECT_NE(list1.Item[1].category.data(), list.Item[1].category.data());
+    ASSERT_EQ(list2.Item.size(), 20000);
+    for (size_t i = 0; i < list2.Item.size(); ++i)
+    {
+        EXPECT_EQ(list2.Item[i].category.data(), list1.Item[i % 2].category.data());
+        if (i % 3 == 0)
+            EXPECT_EQ(list2.Item[i].label->data(), list1.Item[0].label->data());
+        else
+            EXPECT_FALSE(list2.Item[i].label);
+        EXPECT_EQ(list2.Item[i].other_attributes[0].name.data(), list1.Item[0].other_attributes[0].name.data());
+    }
+}
+
+TEST(Features, View)
+{
+    std::string data = R"(<?xml version="1.0" encoding="UTF-8"?>
+<Document>
+    <Title>Tom &amp; Jerry</Title>
+    <Code>TJ</Code>
+    <Entry name="cheese" count="3" tags="yellow holes">Emmental</Entry>
+    <Entry name="&quot;mouse&quot; trap" unit="piece" label="">A <!-- wooden -->trap</Entry>
+</Document>
+)";
+    View::Document document;
+    View::load_view(data, document);
+    EXPECT_EQ(document.Title, "Tom & Jerry");
+    ASSERT_TRUE(document.Code);
+    EXPECT_EQ(*document.Code, "TJ");
+    ASSERT_EQ(document.Entry.size(), 2);
+    EXPECT_EQ(document.Entry[0], "Emmental");
+    EXPECT_EQ(document.Entry[0].name, "cheese");
+    EXPECT_EQ(document.Entry[0].unit, "pcs");
+    EXPECT_FALSE(document.Entry[0].label);
+    EXPECT_EQ(*document.Entry[0].count, 3);
+    ASSERT_EQ(document.Entry[0].tags->size(), 2);
+    EXPECT_EQ((*document.Entry[0].tags)[1], "holes");
+    EXPECT_EQ(document.Entry[1], "A trap");
+    EXPECT_EQ(document.Entry[1].name, "\"mouse\" trap");
+    EXPECT_EQ(document.Entry[1].unit, "piece");
+    EXPECT_EQ(*document.Entry[1].label, "");
+
+    // the strings refer to the input buffer
+    EXPECT_GE(document.Entry[0].name.data(), data.data());
+    EXPECT_LT(document.Entry[0].name.data(), data.data() + data.size());
+    EXPECT_GE((*document.Entry[0].tags)[1].data(), data.data());
+    EXPECT_LT((*document.Entry[0].tags)[1].data(), data.data() + data.size());
+
+    std::string invalidData = "<Document>\n<Title>T</Title><Entry name=\"a\" count=\"x\"/></Document>";
+    xsd::error error;
+    EXPECT_FALSE(View::try_load_view(invalidData, document, error));
+    EXPECT_EQ(error.message(), "Error at line '2': Expected 32-bit integer value");
+}
 
 TEST(Features, Example)
 {
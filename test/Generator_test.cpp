@@ -14,7 +14,7 @@ TEST(Generator, generateCpp)
         Xsd xsd;
         EXPECT_TRUE(Directory::create("test_temp"));
         EXPECT_TRUE(readXsd(String(), inputFile, List<String>(), xsd, error));
-        EXPECT_TRUE(generateCpp(xsd, "test_temp", List<String>(), List<String>(), error));
+        EXPECT_TRUE(generateCpp(xsd, "test_temp", List<String>(), List<String>(), 0, 0, error));
     }
     {
         String inputFile = FOLDER "/SubstitutionGroup.xsd";
@@ -22,6 +22,6 @@ TEST(Generator, generateCpp)
         Xsd xsd;
         EXPECT_TRUE(Directory::create("test_temp"));
         EXPECT_TRUE(readXsd(String(), inputFile, List<String>(), xsd, error));
-        EXPECT_TRUE(generateCpp(xsd, "test_temp", List<String>(), List<String>(), error));
+        EXPECT_TRUE(generateCpp(xsd, "test_temp", List<String>(), List<String>(), 0, 0, error));
     }
 }
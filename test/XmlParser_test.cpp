@@ -1,9 +1,12 @@
 
+#include "../src/xsd.hpp"
 #include "../src/XmlParser.hpp"
 #include "../src/XmlParser.cpp"
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 TEST(Parser, unescapeString)
 {
     struct _
@@ -25,16 +28,38 @@ TEST(Parser, unescapeString)
     EXPECT_EQ(_::unescapeString("a&amp", ";"), "a&amp");
     EXPECT_EQ(_::unescapeString("&#38;&#38;", ""), "&&");
     EXPECT_EQ(_::unescapeString("&#38abc38;", ""), "&#38abc38;");
+    EXPECT_EQ(_::unescapeString("&lt;&gt;&apos;&quot;", ""), "<>'\"");
+    EXPECT_EQ(_::unescapeString("&am;&;&ltx;", ""), "&am;&;&ltx;");
+    EXPECT_EQ(_::unescapeString("&#x20AC;&#128512;", ""), "\xe2\x82\xac\xf0\x9f\x98\x80");
+    EXPECT_EQ(_::unescapeString("&#x20ac;&#0065;&#x10FFFF;", ""), "\xe2\x82\xac" "A\xf4\x8f\xbf\xbf");
+
+    // invalid numeric character references are kept
+    EXPECT_EQ(_::unescapeString("&#;&#x;", ""), "&#;&#x;");
+    EXPECT_EQ(_::unescapeString("&#0;&#x0;", ""), "&#0;&#x0;");
+    EXPECT_EQ(_::unescapeString("&# 38;&#+38;&#-38;&#38 ;", ""), "&# 38;&#+38;&#-38;&#38 ;");
+    EXPECT_EQ(_::unescapeString("&#x+26;&#X26;&#xg;&#3a;", ""), "&#x+26;&#X26;&#xg;&#3a;");
+    EXPECT_EQ(_::unescapeString("&#x110000;&#1114112;&#4294967334;", ""), "&#x110000;&#1114112;&#4294967334;");
+    EXPECT_EQ(_::unescapeString("&#xD800;", ""), "&#xD800;");
+    EXPECT_EQ(_::unescapeString("&#x10FFFF;&#0000000065;&& &amp;", ""), "\xf4\x8f\xbf\xbf&#0000000065;&& &");
+}
+
+TEST(Parser, decodeEntities)
+{
+    char data[] = "a&amp;b&#x20AC;&#128512;&lt;c";
+    char* end = decodeEntities(data, sizeof(data) - 1, data);
+    EXPECT_EQ(std::string(data, end - data), "a&b\xe2\x82\xac\xf0\x9f\x98\x80<c");
 }
 
 TEST(Parser, stripComments)
 {
     struct _
     {
-        static std::string stripComments(const std::string& testStr, const std::string& testSuffix)
+        static std::string stripComments(const std::string& testStr, const std::string& testSuffix, bool unescape = false)
         {
             std::string testData = testStr + testSuffix;
-            return ::stripComments(testData.c_str(), testStr.size());
+            std::string result;
+            ::stripComments(testData.c_str(), testStr.size(), unescape, result);
+            return result;
         }
     };
 
@@ -42,4 +67,174 @@ TEST(Parser, stripComments)
     EXPECT_EQ(_::stripComments("<!-- abc - -->", "abc"), "");
     EXPECT_EQ(_::stripComments("1<!-- abc -->2", "abc"), "12");
     EXPECT_EQ(_::stripComments("1<!-- abc -->2<!-- abc -->3", "abc"), "123");
+    EXPECT_EQ(_::stripComments("&amp;<!-- &amp; -->&lt;", "abc"), "&amp;&lt;");
+    EXPECT_EQ(_::stripComments("&amp;<!-- &amp; -->&lt;", "abc", true), "&<");
+}
+
+template <typename T>
+bool checkSigned(const std::string& str, T& result) { return toSigned(str.c_str(), str.size(), result); }
+template <typename T>
+bool checkUnsigned(const std::string& str, T& result) { return toUnsigned(str.c_str(), str.size(), result); }
+bool checkBool(const std::string& str, bool& result) { return toBool(str.c_str(), str.size(), result); }
+template <typename T>
+bool checkFloat(const std::string& str, T& result) { return toFloat(str.c_str(), str.size(), result); }
+
+TEST(Parser, toNumber)
+{
+    int16_t i16;
+    EXPECT_TRUE(checkSigned(" 32767 ", i16));
+    EXPECT_EQ(i16, 32767);
+    EXPECT_TRUE(checkSigned("-32768", i16));
+    EXPECT_EQ(i16, -32768);
+    EXPECT_TRUE(checkSigned("+12", i16));
+    EXPECT_EQ(i16, 12);
+    EXPECT_FALSE(checkSigned("32768", i16));
+    EXPECT_FALSE(checkSigned("-32769", i16));
+    EXPECT_FALSE(checkSigned("12a", i16));
+    EXPECT_FALSE(checkSigned("1 2", i16));
+    EXPECT_FALSE(checkSigned("", i16));
+    EXPECT_FALSE(checkSigned("-", i16));
+
+    int64_t i64;
+    EXPECT_TRUE(checkSigned("-9223372036854775808", i64));
+    EXPECT_EQ(i64, INT64_MIN);
+    EXPECT_TRUE(checkSigned("9223372036854775807", i64));
+    EXPECT_EQ(i64, INT64_MAX);
+    EXPECT_FALSE(checkSigned("9223372036854775808", i64));
+
+    uint64_t u64;
+    EXPECT_TRUE(checkUnsigned("18446744073709551615", u64));
+    EXPECT_EQ(u64, UINT64_MAX);
+    EXPECT_FALSE(checkUnsigned("18446744073709551616", u64));
+    EXPECT_FALSE(checkUnsigned("-1", u64));
+
+    bool b;
+    EXPECT_TRUE(checkBool("true", b));
+    EXPECT_TRUE(b);
+    EXPECT_TRUE(checkBool(" 0", b));
+    EXPECT_FALSE(b);
+    EXPECT_FALSE(checkBool("yes", b));
+}
+
+TEST(Parser, toFloat)
+{
+    double d;
+    EXPECT_TRUE(checkFloat(" 1.5 ", d));
+    EXPECT_EQ(d, 1.5);
+    EXPECT_TRUE(checkFloat("-0.1", d));
+    EXPECT_EQ(d, -0.1);
+    EXPECT_TRUE(checkFloat("123456.789e3", d));
+    EXPECT_EQ(d, 123456789.0);
+    EXPECT_TRUE(checkFloat("1.", d));
+    EXPECT_EQ(d, 1.0);
+    EXPECT_TRUE(checkFloat(".5", d));
+    EXPECT_EQ(d, 0.5);
+    EXPECT_TRUE(checkFloat("2.2250738585072014E-308", d));
+    EXPECT_EQ(d, 2.2250738585072014E-308);
+    EXPECT_TRUE(checkFloat("9007199254740993", d));
+    EXPECT_EQ(d, 9007199254740992.0);
+    EXPECT_TRUE(checkFloat("0.30000000000000000000000000001", d));
+    EXPECT_EQ(d, 0.3);
+    EXPECT_TRUE(checkFloat("1e400", d));
+    EXPECT_EQ(d, std::numeric_limits<double>::infinity());
+    EXPECT_TRUE(checkFloat("-0", d));
+    EXPECT_TRUE(d == 0.0 && std::signbit(d));
+    EXPECT_TRUE(checkFloat("INF", d));
+    EXPECT_EQ(d, std::numeric_limits<double>::infinity());
+    EXPECT_TRUE(checkFloat("-INF", d));
+    EXPECT_EQ(d, -std::numeric_limits<double>::infinity());
+    EXPECT_TRUE(checkFloat("NaN", d));
+    EXPECT_TRUE(d != d);
+    EXPECT_FALSE(checkFloat("-NaN", d));
+    EXPECT_FALSE(checkFloat("inf", d));
+    EXPECT_FALSE(checkFloat("0x10", d));
+    EXPECT_FALSE(checkFloat("1e", d));
+    EXPECT_FALSE(checkFloat(".", d));
+    EXPECT_FALSE(checkFloat("1.2.3", d));
+    EXPECT_FALSE(checkFloat("", d));
+
+    float f;
+    EXPECT_TRUE(checkFloat("0.1", f));
+    EXPECT_EQ(f, 0.1f);
+    EXPECT_TRUE(checkFloat("16777217", f));
+    EXPECT_EQ(f, 16777216.f);
+    EXPECT_TRUE(checkFloat("3.4028235e38", f));
+    EXPECT_EQ(f, 3.4028235e38f);
+}
+
+TEST(Parser, toFloat_Fallback)
+{
+    // numbers that are not converted with a single multiplication or division do not depend on the locale
+    const char* locales[] = {"de_DE.UTF-8", "de_DE", "fr_FR.UTF-8"};
+    std::string previous = setlocale(LC_NUMERIC, nullptr);
+    for (size_t i = 0; i < sizeof(locales) / sizeof(*locales) && !setlocale(LC_NUMERIC, locales[i]); ++i)
+        ;
+    double d;
+    EXPECT_TRUE(checkFloat("3.14159265358979323846264338327950288", d));
+    EXPECT_EQ(d, 3.14159265358979323846264338327950288);
+    EXPECT_TRUE(checkFloat("1.7976931348623157e308", d));
+    EXPECT_EQ(d, 1.7976931348623157e308);
+    EXPECT_TRUE(checkFloat("4.9406564584124654e-324", d));
+    EXPECT_EQ(d, 4.9406564584124654e-324);
+    EXPECT_TRUE(checkFloat("-123.456e-100", d));
+    EXPECT_EQ(d, -123.456e-100);
+    EXPECT_TRUE(checkFloat(std::string("0.") + std::string(100, '1'), d));
+    EXPECT_EQ(d, 0.11111111111111111111);
+    float f;
+    EXPECT_TRUE(checkFloat("1.17549435e-38", f));
+    EXPECT_EQ(f, 1.17549435e-38f);
+    EXPECT_TRUE(checkFloat("2.718281828459045235360287", f));
+    EXPECT_EQ(f, 2.718281828459045235360287f);
+    setlocale(LC_NUMERIC, previous.c_str());
+}
+
+template <typename Class>
+void checkScan(const std::string& data, const Class& charClass)
+{
+    Context context;
+    context.end = data.c_str() + data.size();
+    context.scanLevel = scalarScanLevel;
+    const char* expected = scan(context, charClass, data.c_str());
+    Location expectedLocation = { 1, 1 };
+    locate(context, data.c_str(), expected, expectedLocation);
+    for (int level = scalarScanLevel; level <= getScanLevel(); ++level)
+    {
+        context.scanLevel = (ScanLevel)level;
+        EXPECT_EQ(scan(context, charClass, data.c_str()), expected);
+        Location location = { 1, 1 };
+        locate(context, data.c_str(), expected, location);
+        EXPECT_EQ(location.line, expectedLocation.line);
+        EXPECT_EQ(location.column, expectedLocation.column);
+        location = { 1, 1 };
+        locate(context, data.c_str(), context.end, location);
+        Location splitLocation = { 1, 1 };
+        locate(context, data.c_str(), expected, splitLocation);
+        locate(context, expected, context.end, splitLocation);
+        if (expected == context.end || expected == data.c_str() || expected[-1] != '\r' || *expected != '\n')
+        {
+            EXPECT_EQ(splitLocation.line, location.line);
+            EXPECT_EQ(splitLocation.column, location.column);
+        }
+    }
+}
+
+TEST(Parser, scan)
+{
+    const char chars[] = " \t\r\n\r\n<-ab=/>\"'";
+    unsigned int seed = 42;
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::string data;
+        for (size_t length = i % 100; data.size() < length;)
+        {
+            seed = seed * 1103515245 + 12345;
+            data.push_back(chars[(seed >> 16) % (sizeof(chars) - 1)]);
+        }
+        checkScan(data, SpaceClass());
+        checkScan(data, CharClass<'<'>());
+        checkScan(data, CharClass<'-'>());
+        checkScan(data, StringClass('"'));
+        checkScan(data, TagClass());
+        checkScan(data, NameClass());
+    }
 }
@@ -3,6 +3,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 TEST(XsdLib, optional_base)
 {
     xsd::optional<int32_t> i32;
@@ -25,6 +27,115 @@ TEST(XsdLib, optional)
     a = A{1,23};
 }
 
+TEST(XsdLib, optional_inline)
+{
+    xsd::optional<std::string> a;
+    EXPECT_FALSE(a);
+    a = std::string("a string that is too long to be stored inline");
+    ASSERT_TRUE(a);
+    EXPECT_EQ(*a, "a string that is too long to be stored inline");
+    EXPECT_EQ(a->size(), 45);
+
+    xsd::optional<std::string> b(a);
+    EXPECT_TRUE(a == b);
+    xsd::optional<std::string> c(std::move(a));
+    EXPECT_FALSE(a);
+    EXPECT_TRUE(c == b);
+    a = c;
+    EXPECT_TRUE(a == c);
+    a = xsd::optional<std::string>();
+    EXPECT_FALSE(a);
+    EXPECT_TRUE(a != c);
+
+    EXPECT_EQ(sizeof(xsd::optional<int32_t>), 8);
+    EXPECT_TRUE(std::is_nothrow_move_constructible<xsd::optional<std::string>>::value);
+    EXPECT_TRUE(std::is_nothrow_move_constructible<xsd::boxed_optional<std::string>>::value);
+}
+
+TEST(XsdLib, boxed_optional)
+{
+    struct A
+    {
+        xsd::boxed_optional<A> a;
+        int b;
+    };
+
+    A a = A{xsd::boxed_optional<A>(), 0};
+    EXPECT_FALSE(a.a);
+    a.a = A{xsd::boxed_optional<A>(), 23};
+    ASSERT_TRUE(a.a);
+    EXPECT_EQ(a.a->b, 23);
+    A b(std::move(a));
+    EXPECT_FALSE(a.a);
+    EXPECT_EQ(b.a->b, 23);
+}
+
+TEST(XsdLib, interned_string)
+{
+    xsd::interned_string empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty, "");
+
+    xsd::interned_string a("abc");
+    xsd::interned_string b(std::string("abc"));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a.data(), b.data()); // no table is current
+    EXPECT_EQ(a, "abc");
+    EXPECT_EQ(std::string("abc"), a);
+    EXPECT_NE(a, "abcd");
+    EXPECT_EQ(a.size(), 3);
+    EXPECT_EQ(std::string(a.c_str()), "abc");
+
+    xsd::interned_string c(a);
+    EXPECT_EQ(c.data(), a.data());
+    b = std::move(c);
+    EXPECT_EQ(b.data(), a.data());
+    EXPECT_TRUE(c.empty());
+    a = xsd::interned_string();
+    EXPECT_EQ(b, "abc");
+}
+
+TEST(XsdLib, intern_table)
+{
+    xsd::interned_string outlived;
+    {
+        xsd::intern_table table;
+        xsd::intern_table::scope scope(table);
+        std::vector<xsd::interned_string> strings;
+        for (int i = 0; i < 2000; ++i)
+            strings.push_back(xsd::interned_string(std::to_string(i % 1000)));
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_EQ(strings[i], std::to_string(i));
+            EXPECT_EQ(strings[i].data(), strings[i + 1000].data());
+        }
+        outlived = strings[123];
+        EXPECT_EQ(table.intern("123", 3).data(), outlived.data());
+    }
+    EXPECT_EQ(xsd::intern_table::current(), nullptr);
+    EXPECT_EQ(outlived, "123");
+}
+
+TEST(XsdLib, string_view)
+{
+    const char data[] = "abcabc";
+    xsd::string_view empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty, "");
+    xsd::string_view a(data, 3);
+    xsd::string_view b(data + 3, 3);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, "abc");
+    EXPECT_EQ("abc", b);
+    EXPECT_EQ(a, std::string("abc"));
+    EXPECT_NE(a, "abcabc");
+    EXPECT_NE(a, xsd::string_view(data, 2));
+    EXPECT_EQ(a.str(), "abc");
+    std::string s = b;
+    EXPECT_EQ(s, "abc");
+    EXPECT_EQ(b.data(), data + 3);
+}
+
 TEST(XsdLib, base)
 {
     xsd::base<int32_t> a(23);
@@ -0,0 +1,125 @@
+
+#include "Example.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace {
+
+std::string listData(int persons)
+{
+    std::string data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<List>\n";
+    for (int i = 0; i < persons; ++i)
+        data += "    <Person><Name age=\"" + std::to_string(i) + "\" comment=\"a comment that does not fit into a short string\">Person with a rather long name " + std::to_string(i) + "</Name><Country>DE</Country></Person>\n";
+    data += "</List>\n";
+    return data;
+}
+
+}
+
+TEST(Arena, Allocate)
+{
+    xsd::arena arena(64);
+    char* a = (char*)arena.allocate(1, 1);
+    char* b = (char*)arena.allocate(8, 8);
+    EXPECT_EQ((uintptr_t)b % 8, 0);
+    EXPECT_GT(b, a);
+    char* c = (char*)arena.allocate(1000, 16);
+    EXPECT_EQ((uintptr_t)c % 16, 0);
+    memset(c, 0, 1000);
+    arena.reset();
+    arena.allocate(10, 1);
+}
+
+TEST(Arena, Allocator)
+{
+    xsd::allocator<int> heapAllocator;
+    xsd::arena arena;
+    {
+        xsd::arena::scope scope(arena);
+        xsd::allocator<int> arenaAllocator;
+        EXPECT_NE(heapAllocator, arenaAllocator);
+        EXPECT_EQ(arenaAllocator, xsd::allocator<int>(xsd::allocator<char>()));
+    }
+    EXPECT_EQ(heapAllocator, xsd::allocator<int>());
+}
+
+TEST(Arena, LoadData)
+{
+    std::string data = listData(1000);
+    xsd::arena arena;
+    {
+        xsd::arena::scope scope(arena);
+        Example::List* list = arena.create<Example::List>();
+        Example::load_data(data, *list);
+        ASSERT_EQ(list->Person.size(), 1000);
+        EXPECT_EQ(list->Person[10].Name, "Person with a rather long name 10");
+        EXPECT_EQ(list->Person[10].Name.age, 10);
+        EXPECT_EQ(*list->Person[10].Name.comment, "a comment that does not fit into a short string");
+        EXPECT_EQ(*list->Person[10].Country, Example::CountryCode::DE);
+        EXPECT_EQ(list->Person.get_allocator(), xsd::allocator<Example::Person>());
+        EXPECT_EQ(list->Person[10].Name.get_allocator(), xsd::allocator<char>());
+    }
+    arena.reset(); // releases the list without destroying it
+
+    // the model can still be used without an arena
+    Example::List list;
+    Example::load_data(data, list);
+    ASSERT_EQ(list.Person.size(), 1000);
+    EXPECT_EQ(list.Person[999].Name, "Person with a rather long name 999");
+    EXPECT_EQ(list.Person.get_allocator(), xsd::allocator<Example::Person>());
+}
+
+TEST(Arena, LoadDataParallel)
+{
+    std::string data = listData(10000);
+    xsd::arena arena;
+    xsd::arena::scope scope(arena);
+    Example::List* list = arena.create<Example::List>();
+    Example::load_data_parallel(data.data(), data.size(), *list, 4);
+    ASSERT_EQ(list->Person.size(), 10000);
+    for (int i = 0; i < 10000; ++i)
+        EXPECT_EQ(list->Person[i].Name.age, i);
+    EXPECT_EQ(list->Person[9999].Name, "Person with a rather long name 9999");
+}
+
+TEST(Arena, InternTable)
+{
+    xsd::intern_table table;
+    xsd::intern_table::scope tableScope(table);
+    xsd::arena arena;
+    for (int i = 0; i < 2; ++i)
+    {
+        {
+            xsd::arena::scope scope(arena);
+            xsd::interned_string a("a string that is shared");
+            xsd::interned_string b("a string that is shared");
+            EXPECT_EQ(a.data(), b.data());
+        }
+        arena.reset(); // the strings of the table are not allocated from the arena
+    }
+    EXPECT_EQ(table.intern("a string that is shared", 23), "a string that is shared");
+}
+
+TEST(Arena, Copy)
+{
+    std::string data = listData(10);
+    Example::List copy;
+    {
+        xsd::arena arena;
+        Example::List* list;
+        {
+            xsd::arena::scope scope(arena);
+            list = arena.create<Example::List>();
+            Example::load_data(data, *list);
+        }
+
+        // a copy that is made outside of the scope does not use the arena
+        copy = *list;
+        EXPECT_EQ(copy.Person[3].Name.get_allocator(), xsd::allocator<char>());
+    }
+    ASSERT_EQ(copy.Person.size(), 10);
+    EXPECT_EQ(copy.Person[3].Name, "Person with a rather long name 3");
+    EXPECT_EQ(*copy.Person[3].Name.comment, "a comment that does not fit into a short string");
+}
@@ -0,0 +1,164 @@
+
+#include "Example.hpp"
+#include "ExampleView.hpp"
+#include "Recursion.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+
+namespace {
+
+const char* _filePath = "Benchmark.xml";
+
+void generateFile(size_t persons)
+{
+    std::ofstream file(_filePath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<List>\n";
+    for (size_t i = 0; i < persons; ++i)
+        file << "    <Person>\n        <Name age=\"" << (i % 100) << "\" comment=\"person " << i << "\">John Smith</Name>\n        <Country>UK</Country>\n    </Person>\n";
+    file << "</List>\n";
+}
+
+// A document with chains of nested elements of the given depth.
+std::string generateNestedData(size_t elements, size_t depth)
+{
+    std::string data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Main1 channel=\"root\">\n";
+    for (size_t i = 0; i < elements; i += depth)
+    {
+        for (size_t j = 0; j < depth; ++j)
+            data += "<SubMain channel=\"a\">";
+        for (size_t j = 0; j < depth; ++j)
+            data += "</SubMain>";
+        data += "\n";
+    }
+    data += "</Main1>\n";
+    return data;
+}
+
+// A list of persons whose attribute values and names contain entity references.
+std::string generateEscapedData(size_t persons)
+{
+    std::string data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<List>\n";
+    for (size_t i = 0; i < persons; ++i)
+        data += "    <Person>\n        <Name age=\"" + std::to_string(i % 100) + "\" comment=\"&quot;person&quot; " + std::to_string(i) + "\">John &amp; Jane Smith</Name>\n    </Person>\n";
+    data += "</List>\n";
+    return data;
+}
+
+double measure(const char* name, const std::function<void()>& function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-32s %8.3f s\n", name, seconds);
+    return seconds;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t persons = argc > 1 ? (size_t)strtoull(argv[1], nullptr, 10) : 1000000;
+    generateFile(persons);
+
+    measure("fstream, stringstream, load_data", []() {
+        std::fstream file;
+        file.exceptions(std::fstream::failbit | std::fstream::badbit);
+        file.open(_filePath, std::fstream::in);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        Example::List list;
+        Example::load_data(buffer.str(), list);
+    });
+
+    measure("load_file", []() {
+        Example::List list;
+        Example::load_file(_filePath, list);
+    });
+
+    measure("load_file_parallel", []() {
+        Example::List list;
+        Example::load_file_parallel(_filePath, list);
+    });
+
+    measure("load_file with callbacks", []() {
+        size_t persons = 0;
+        Example::ListCallbacks callbacks;
+        callbacks.List_Person = [&](Example::Person&) { ++persons; };
+        Example::List list;
+        Example::load_file(_filePath, list, callbacks);
+    });
+
+    measure("parse_file", []() {
+        struct Handler : Example::ListHandler
+        {
+            size_t persons = 0;
+            void on_end_Person(const Example::Person&) override { ++persons; }
+        } handler;
+        Example::parse_file(_filePath, handler);
+    });
+
+    std::string nestedData = generateNestedData(persons, 1000);
+    measure("load_data nested 1000 deep", [&]() {
+        Recursion::MainType1 main1;
+        Recursion::load_data(nestedData, main1);
+    });
+
+    std::string escapedData = generateEscapedData(persons);
+    measure("load_data escaped", [&]() {
+        Example::List list;
+        Example::load_data(escapedData, list);
+    });
+
+    measure("load_data_in_place escaped", [&]() {
+        Example::List list;
+        Example::load_data_in_place(&escapedData[0], escapedData.size(), list);
+    });
+
+    escapedData = generateEscapedData(persons);
+    measure("load_view escaped", [&]() {
+        ExampleView::List list;
+        ExampleView::load_view(escapedData, list);
+    });
+
+    std::string smallData = "<List><Person><Name age=\"40\">John Smith</Name><Country>UK</Country></Person></List>";
+    measure("load_data small documents", [&]() {
+        for (size_t i = 0; i < persons; ++i)
+        {
+            Example::List list;
+            Example::load_data(smallData, list);
+        }
+    });
+
+    std::string invalidData = "<List><Person><Name age=\"40\">John Smith</Name><Country>XX</Country></Person></List>";
+    measure("load_data invalid documents", [&]() {
+        for (size_t i = 0; i < persons; ++i)
+        {
+            Example::List list;
+            try
+            {
+                Example::load_data(invalidData, list);
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    });
+
+    measure("try_load_data invalid documents", [&]() {
+        xsd::error error;
+        for (size_t i = 0; i < persons; ++i)
+        {
+            Example::List list;
+            Example::try_load_data(invalidData, list, error);
+        }
+    });
+
+    std::remove(_filePath);
+    return 0;
+}
@@ -105,6 +105,7 @@ TEST(Ecoa_componentType, anyAttribute)
 </csa:componentType>)";
     sca_1_1_cd06_subset_2_0::ComponentType componentType;
     sca_1_1_cd06_subset_2_0::load_data(data, componentType);
+    static_assert(std::is_same<decltype(componentType.property[0].other_attributes[0].name), std::string>::value, "");
     EXPECT_EQ(componentType.property[0].other_attributes[0].name, "ecoa-sca:type");
     EXPECT_EQ(componentType.property[0].other_attributes[0].value, "Dining:Philosopher_id");
     EXPECT_EQ(componentType.property[0].other_attributes[1].name, "ecoa-sca:library");
@@ -139,6 +140,66 @@ TEST(Ecoa_composite, skipProcessing)
         EXPECT_EQ(composite.component[0].property[0].name, "ID");
         EXPECT_EQ(composite.component[0].property[0], "<csa:value><csa:property>3</csa:property></csa:value>");
     }
+
+    {
+        std::string data = R"(<csa:composite name="xy" targetNamespace="http://www.ecoa.technology/default">
+    <csa:component name="Socrates">
+        <csa:property name="ID"><a x="</csa:property>"/><!-- </csa:property> --><b y='>'>
+<![CDATA[</csa:property>]]></b><?pi </csa:property>?></csa:property>
+    </csa:component>
+</csa:composite>)";
+
+        sca_1_1_cd06_subset_2_0::Composite composite;
+        sca_1_1_cd06_subset_2_0::load_data(data, composite);
+        EXPECT_EQ(composite.component.size(), 1);
+        EXPECT_EQ(composite.component[0].property[0], "<a x=\"</csa:property>\"/><!-- </csa:property> --><b y='>'>\n<![CDATA[</csa:property>]]></b><?pi </csa:property>?>");
+
+        // the end tag is also found if the document is split at any position
+        sca_1_1_cd06_subset_2_0::compositeParser parser;
+        for (size_t i = 0; i < data.size(); ++i)
+            parser.write(data.data() + i, 1);
+        sca_1_1_cd06_subset_2_0::Composite pushedComposite;
+        parser.finish(pushedComposite);
+        EXPECT_EQ(pushedComposite.component[0].property[0], composite.component[0].property[0]);
+    }
+
+    {
+        std::string content;
+        for (int i = 0; i < 100000; ++i)
+            content += "<a>";
+        for (int i = 0; i < 100000; ++i)
+            content += "</a>";
+        std::string data = R"(<csa:composite name="xy" targetNamespace="http://www.ecoa.technology/default">
+    <csa:component name="Socrates">
+        <csa:property name="ID">)" + content + R"(</csa:property>
+        <csa:property name="Invalid"/>
+    </csa:component>
+</csa:composite>)";
+
+        sca_1_1_cd06_subset_2_0::Composite composite;
+        sca_1_1_cd06_subset_2_0::load_data(data, composite);
+        EXPECT_EQ(composite.component[0].property.size(), 2);
+        EXPECT_EQ(composite.component[0].property[0], content);
+    }
+
+    {
+        std::string data = R"(<csa:composite name="xy" targetNamespace="http://www.ecoa.technology/default">
+    <csa:component name="Socrates">
+        <csa:property name="ID"><a></csa:property>
+    </csa:component>
+</csa:composite>)";
+
+        sca_1_1_cd06_subset_2_0::Composite composite;
+        try
+        {
+            sca_1_1_cd06_subset_2_0::load_data(data, composite);
+            FAIL();
+        }
+        catch (const std::exception& e)
+        {
+            EXPECT_EQ(std::string(e.what()), "Syntax error at line '4': Expected end tag of 'csa:property'");
+        }
+    }
 }
 
 TEST(Ecoa_deployment, Constructor)
@@ -0,0 +1,59 @@
+
+#include "Example.hpp"
+
+#include <gtest/gtest.h>
+
+#ifdef XSDCPP_EXCEPTIONS
+#error "This test has to be compiled without exceptions"
+#endif
+
+TEST(NoExceptions, TryLoadData)
+{
+    Example::List list;
+    xsd::error error;
+    EXPECT_TRUE(Example::try_load_data("<List><Person><Name age=\"40\">John</Name><Country>DE</Country></Person></List>", list, error));
+    ASSERT_EQ(list.Person.size(), 1);
+    EXPECT_EQ(list.Person[0].Name, "John");
+    EXPECT_EQ(*list.Person[0].Country, Example::CountryCode::DE);
+
+    EXPECT_FALSE(Example::try_load_data("<List><Person><Name age=\"x\">John</Name></Person></List>", list, error));
+    EXPECT_EQ(error.code, xsd::error::expected_int32);
+    EXPECT_EQ(error.message(), "Error at line '1': Expected 32-bit integer value");
+
+    EXPECT_FALSE(Example::try_load_data("<List><Person><Name age=\"40\">John</Name></Person>", list, error));
+    EXPECT_EQ(error.code, xsd::error::unexpected_end);
+
+    EXPECT_FALSE(Example::try_load_file("does_not_exist.xml", list, error));
+    EXPECT_EQ(error.code, xsd::error::file_error);
+}
+
+TEST(NoExceptions, LoadFiles)
+{
+    std::vector<std::string> files(2, "does_not_exist.xml");
+    std::vector<Example::List> lists;
+    std::vector<xsd::error> errors = Example::load_files(files, lists);
+    ASSERT_EQ(errors.size(), 2);
+    EXPECT_EQ(errors[1].code, xsd::error::file_error);
+    EXPECT_EQ(errors[1].text, "does_not_exist.xml");
+}
+
+TEST(NoExceptions, TryParseData)
+{
+    struct Handler : Example::ListHandler
+    {
+        size_t persons = 0;
+        void on_end_Person(const Example::Person&) override { ++persons; }
+    } handler;
+    xsd::error error;
+    EXPECT_TRUE(Example::try_parse_data("<List><Person><Name age=\"40\">John</Name></Person></List>", handler, error));
+    EXPECT_EQ(handler.persons, 1);
+    EXPECT_FALSE(Example::try_parse_data("<List><Person><Name age=\"40\">John</Name><Name age=\"41\">Mary</Name></Person></List>", handler, error));
+    EXPECT_EQ(error.code, xsd::error::max_occurs);
+
+    Example::List list;
+    Example::ListParser parser;
+    EXPECT_TRUE(parser.try_write("<List><Person><Name age=\"40\">Jo", 31, error));
+    EXPECT_TRUE(parser.try_write("hn</Name></Person>", 18, error));
+    EXPECT_FALSE(parser.try_finish(list, error));
+    EXPECT_EQ(error.code, xsd::error::unexpected_end);
+}